@@ -834,6 +834,81 @@ void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei widt
     free(swizzle_buf);
 }
 
+// Takes ETC1 blocks (8 bytes, big endian) or ETC1A4 blocks (8 bytes of
+// alpha followed by the ETC1 word) in raster order of a bottom-up image.
+// The PICA200 wants them grouped in 8x8 tiles of 2x2 blocks, each word
+// little endian.
+void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid *data) {
+    if(!cur_texture)
+        return;
+
+    int has_alpha = (internalformat == GL_ETC1_ALPHA4_3DS);
+    int block_size = has_alpha ? 16 : 8;
+    int blocks_w = width / 4;
+    u32 size = (width / 4) * (height / 4) * block_size;
+
+    if(imageSize != size || (width & 7) || (height & 7))
+        return;
+
+    if(cur_texture->c3d_tex.data) {
+        linearFree(cur_texture->c3d_tex.data);
+        cur_texture->c3d_tex.data = NULL;
+    }
+
+    cur_texture->c3d_tex.width = width;
+    cur_texture->c3d_tex.height = height;
+    cur_texture->c3d_tex.data = linearAlloc(size);
+    cur_texture->c3d_tex.fmt = has_alpha ? GPU_ETC1A4 : GPU_ETC1;
+    cur_texture->c3d_tex.size = size;
+
+    const u8 *src = (const u8*)data;
+    u8 *dst_base = (u8*)cur_texture->c3d_tex.data;
+
+    for(int by = 0; by < height / 4; by++) {
+        for(int bx = 0; bx < blocks_w; bx++) {
+            int tile = (by / 2) * (width / 8) + (bx / 2);
+            int sub = (bx & 1) + (by & 1) * 2;
+            u8 *dst = dst_base + (tile * 4 + sub) * block_size;
+
+            if(has_alpha) {
+                memcpy(dst, src, 8);
+                dst += 8;
+                src += 8;
+            }
+
+            for(int i = 0; i < 8; i++)
+                dst[i] = src[7 - i];
+            src += 8;
+        }
+    }
+}
+
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid *pixels) {
+    if(!cur_texture || !cur_texture->c3d_tex.data || !pixels)
+        return;
+
+    u32 tex_width = cur_texture->c3d_tex.width;
+    u32 tex_height = cur_texture->c3d_tex.height;
+    u8 *texbuf = (u8*)cur_texture->c3d_tex.data;
+    const u32 *src = (const u32*)pixels;
+
+    if(xoffset < 0 || yoffset < 0 || xoffset + width > tex_width || yoffset + height > tex_height)
+        return;
+
+    // Swizzle only the updated texels into place
+    for(int y = 0; y < height; y++) {
+        for(int x = 0; x < width; x++) {
+            u32 c = src[(y * width) + x];
+
+            *((u32*)(texbuf + GetPixelOffset(xoffset + x, yoffset + y, tex_width, tex_height))) =
+                ((c & 0xff000000) >> 24) |
+                ((c & 0x00ff0000) >> 8) |
+                ((c & 0x0000ff00) << 8) |
+                ((c & 0x000000ff) << 24);
+        }
+    }
+}
+
 void glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height) {
     if(!cur_texture)
         return;
@@ -129,6 +129,9 @@ typedef void GLvoid;
 #define GL_RGB5_A1 0x8057
 #define GL_RGBA8 0x8058
 
+#define GL_ETC1_RGB8_OES 0x8D64
+#define GL_ETC1_ALPHA4_3DS 0x8D65 // not a GL enum, ETC1 with 4 bit alpha
+
 #define GL_TEXTURE0 0x84C0
 
 #define GL_COMBINE 0x8570
@@ -202,6 +205,8 @@ void glGenTextures(GLsizei n, GLuint *textures);
 void glBindTexture(GLenum target, GLuint texture);
 void glTexParameteri(GLenum target, GLenum pname, GLint param);
 void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid *pixels);
+void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid *data);
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid *pixels);
 void glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height);
 void glDeleteTextures(GLsizei n, const GLuint *textures);
 
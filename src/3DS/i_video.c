@@ -43,9 +43,11 @@
 #include "doomdef.h"
 #include "doomtype.h"
 #include "v_video.h"
+#include "v_present.h"
 #include "r_draw.h"
 #include "r_things.h"
 #include "r_plane.h"
+#include "r_segs.h"
 #include "r_main.h"
 #include "f_wipe.h"
 #include "d_main.h"
@@ -245,10 +247,21 @@ extern const unsigned char _acbottom_on[];
 //
 // I_DrawBottomScreen
 //
+// The image only changes with the input mode; the bottom screen is single
+// buffered, so it is copied once after that and left alone otherwise.
+//
 static void I_DrawBottomScreen (void)
 {
-  u8 *framebuf = gfxGetFramebuffer(GFX_BOTTOM, GFX_LEFT, NULL, NULL);
+  static int bottom_mode = -1;
+  u8 *framebuf;
+
+  if (ctr_input_mode == bottom_mode)
+    return;
+  bottom_mode = ctr_input_mode;
+
+  framebuf = gfxGetFramebuffer(GFX_BOTTOM, GFX_LEFT, NULL, NULL);
   memcpy(framebuf, ctr_input_mode ? _acbottom_on : _acbottom_off, 240*320*3);
+  v_presented_bytes += 240*320*3;
 }
 
 //
@@ -340,12 +353,56 @@ void I_UpdateNoBlit (void)
 {
 }
 
-static inline u16 argb1555_2_rgba5551(u16 x) {
-  return (x << 1) | ((x & 0x8000) >> 15);
-}
+//
+// I_PresentTiles
+//
+// Converts the dirty tiles of screen 0 into the top framebuffer, which is
+// rotated: 240 pixels per column, bottom up. Runs of dirty tiles in a tile
+// row go to the present kernel as one rectangle.
+//
+static void I_PresentTiles(void)
+{
+  void *fb = gfxGetFramebuffer(GFX_TOP, GFX_LEFT, NULL, NULL);
+  video_mode_t mode = V_GetMode();
+  const byte *tiles;
+  int cols, rows, tx, ty;
+
+  tiles = V_GetPresentTiles(&cols, &rows);
 
-static inline u32 argb8_2_rgba8(u32 x) {
-  return (x << 8) | ((x & 0xff000000) >> 24);
+  for (ty = 0; ty < rows; ty++)
+  {
+    for (tx = 0; tx < cols; tx++)
+    {
+      int x1, x2, y1, y2;
+
+      if (!tiles[ty * cols + tx])
+        continue;
+
+      x1 = tx << V_DIRTY_TILE_SHIFT;
+      while (tx + 1 < cols && tiles[ty * cols + tx + 1])
+        tx++;
+      x2 = MIN((tx + 1) << V_DIRTY_TILE_SHIFT, SCREENWIDTH);
+      y1 = ty << V_DIRTY_TILE_SHIFT;
+      y2 = MIN(y1 + V_DIRTY_TILE, SCREENHEIGHT);
+
+      switch (mode) {
+      case VID_MODE15:
+        V_RotateRect15((unsigned short *)screens[0].data, screens[0].short_pitch,
+                       fb, 240, x1, y1, x2, y2);
+        break;
+      case VID_MODE16:
+        V_RotateRect16((unsigned short *)screens[0].data, screens[0].short_pitch,
+                       fb, 240, x1, y1, x2, y2);
+        break;
+      default: // VID_MODE32
+        V_RotateRect32((unsigned int *)screens[0].data, screens[0].int_pitch,
+                       fb, 240, x1, y1, x2, y2);
+        break;
+      }
+
+      v_presented_bytes += (x2 - x1) * (y2 - y1) * V_GetPixelDepth();
+    }
+  }
 }
 
 //
@@ -370,56 +427,7 @@ void I_FinishUpdate (void)
   }
 #endif
 
-  switch(V_GetMode()) {
-  case VID_MODE15:
-  {
-    u16* dst_ptr = (u16*)gfxGetFramebuffer(GFX_TOP, GFX_LEFT, NULL, NULL) + 239;
-    u16* src_ptr = (u16*)screens[0].data;
-
-    for(int y = 0; y < 240; y++) {
-      for(int x = 0; x < 400; x++) {
-        *dst_ptr = argb1555_2_rgba5551(*src_ptr);
-
-        dst_ptr += 240;
-        src_ptr++;
-      }
-      dst_ptr -= (400 * 240) + 1;
-    }
-    break;
-  }
-  case VID_MODE16:
-  {
-    u16* dst_ptr = (u16*)gfxGetFramebuffer(GFX_TOP, GFX_LEFT, NULL, NULL) + 239;
-    u16* src_ptr = (u16*)screens[0].data;
-
-    for(int y = 0; y < 240; y++) {
-      for(int x = 0; x < 400; x++) {
-        *dst_ptr = *src_ptr;
-
-        dst_ptr += 240;
-        src_ptr++;
-      }
-      dst_ptr -= (400 * 240) + 1;
-    }
-    break;
-  }
-  default: // VID_MODE32
-  {
-    u32* dst_ptr = (u32*)gfxGetFramebuffer(GFX_TOP, GFX_LEFT, NULL, NULL) + 239;
-    u32* src_ptr = (u32*)screens[0].data;
-
-    for(int y = 0; y < 240; y++) {
-      for(int x = 0; x < 400; x++) {
-        *dst_ptr = argb8_2_rgba8(*src_ptr);
-
-        dst_ptr += 240;
-        src_ptr++;
-      }
-      dst_ptr -= (400 * 240) + 1;
-    }
-    break;
-  }
-  }
+  I_PresentTiles();
 
   // Draw!
 
@@ -451,6 +459,7 @@ static void I_InitBuffersRes(void)
   R_InitBuffersRes();
   R_InitPlanesRes();
   R_InitVisplanesRes();
+  R_InitSegsRes();
 }
 
 //
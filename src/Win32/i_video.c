@@ -46,6 +46,7 @@
 #include "r_draw.h"
 #include "r_things.h"
 #include "r_plane.h"
+#include "r_segs.h"
 #include "r_main.h"
 #include "f_wipe.h"
 #include "d_main.h"
@@ -427,6 +428,7 @@ static void I_InitBuffersRes(void)
   R_InitBuffersRes();
   R_InitPlanesRes();
   R_InitVisplanesRes();
+  R_InitSegsRes();
 }
 
 //
@@ -521,9 +521,9 @@ void AM_SetPosition(void)
     if (f_y + f_h > SCREENHEIGHT)
       f_h = SCREENHEIGHT - f_y;
 
-    f_x = viewwindowx + f_x * viewwidth / SCREENWIDTH;
+    f_x = viewwindowx + f_x * scaledviewwidth / SCREENWIDTH;
     f_y = viewwindowy + f_y * viewheight / SCREENHEIGHT;
-    f_w = f_w * viewwidth / SCREENWIDTH;
+    f_w = f_w * scaledviewwidth / SCREENWIDTH;
     f_h = f_h * viewheight / SCREENHEIGHT;
   }
   else
@@ -910,6 +910,212 @@ void AM_rotatePoint(mpoint_t *p)
   p->x = tmpx;
 }
 
+//
+// Automap spatial index
+//
+// A uniform grid over the level, built the first time the automap is
+// drawn on it. Each cell lists the lines and sectors whose
+// bounding boxes touch it, so the drawers only visit what may be inside
+// the frame instead of walking every line and sector. The grid lives in
+// PU_LEVEL memory and the zone clears amgrid when the level is freed.
+//
+// The rotated map coordinates of vertexes are cached as well, and stay
+// valid for as long as the pan, zoom and rotation do not change.
+//
+
+#define AMGRID_SHIFT (MAPBITS + 8) // 256 unit cells, in map coords
+
+typedef struct
+{
+  int *start;       // width*height+1 offsets into list
+  int *list;        // line or sector numbers, ascending per cell
+  int *stamp;       // last query that returned each entry
+  int *result;      // query output
+} amgrid_cells_t;
+
+typedef struct
+{
+  int x, y;         // lower left corner, in map coords
+  int width, height;
+  amgrid_cells_t lines;
+  amgrid_cells_t sectors;
+  int querystamp;
+
+  mpoint_t *vertexes; // transformed vertex cache
+  int *vertexstamp;
+  int transformstamp;
+} amgrid_t;
+
+static amgrid_t *amgrid;
+
+static void AM_lineBox(int i, int *box)
+{
+  box[BOXLEFT] = lines[i].bbox[BOXLEFT] >> FRACTOMAPBITS;
+  box[BOXRIGHT] = lines[i].bbox[BOXRIGHT] >> FRACTOMAPBITS;
+  box[BOXBOTTOM] = lines[i].bbox[BOXBOTTOM] >> FRACTOMAPBITS;
+  box[BOXTOP] = lines[i].bbox[BOXTOP] >> FRACTOMAPBITS;
+}
+
+static void AM_sectorBox(int i, int *box)
+{
+  memcpy(box, sectors[i].bbox, sizeof(sectors[i].bbox));
+}
+
+// Cell range covered by a map coords bounding box, false if it is outside
+// of the grid.
+
+static dboolean AM_gridRange(const int *box, int *x1, int *x2, int *y1, int *y2)
+{
+  *x1 = (int)(((int_64_t)box[BOXLEFT] - amgrid->x) >> AMGRID_SHIFT);
+  *x2 = (int)(((int_64_t)box[BOXRIGHT] - amgrid->x) >> AMGRID_SHIFT);
+  *y1 = (int)(((int_64_t)box[BOXBOTTOM] - amgrid->y) >> AMGRID_SHIFT);
+  *y2 = (int)(((int_64_t)box[BOXTOP] - amgrid->y) >> AMGRID_SHIFT);
+
+  if (*x2 < 0 || *x1 >= amgrid->width || *y2 < 0 || *y1 >= amgrid->height)
+    return false;
+
+  *x1 = MAX(*x1, 0);
+  *y1 = MAX(*y1, 0);
+  *x2 = MIN(*x2, amgrid->width - 1);
+  *y2 = MIN(*y2, amgrid->height - 1);
+  return true;
+}
+
+static void AM_gridFill(amgrid_cells_t *cells, int count, void (*getbox)(int, int *))
+{
+  int numcells = amgrid->width * amgrid->height;
+  int i, x, y, x1, x2, y1, y2, box[4];
+  int *fill;
+
+  // count the entries of each cell, then lay the cells out back to back
+  cells->start = Z_Calloc(numcells + 1, sizeof(*cells->start), PU_LEVEL, NULL);
+  for (i = 0; i < count; i++)
+  {
+    getbox(i, box);
+    if (AM_gridRange(box, &x1, &x2, &y1, &y2))
+      for (y = y1; y <= y2; y++)
+        for (x = x1; x <= x2; x++)
+          cells->start[y * amgrid->width + x + 1]++;
+  }
+  for (i = 0; i < numcells; i++)
+    cells->start[i + 1] += cells->start[i];
+
+  cells->list = Z_Malloc(cells->start[numcells] * sizeof(*cells->list), PU_LEVEL, NULL);
+  fill = malloc(numcells * sizeof(*fill));
+  memcpy(fill, cells->start, numcells * sizeof(*fill));
+  for (i = 0; i < count; i++)
+  {
+    getbox(i, box);
+    if (AM_gridRange(box, &x1, &x2, &y1, &y2))
+      for (y = y1; y <= y2; y++)
+        for (x = x1; x <= x2; x++)
+          cells->list[fill[y * amgrid->width + x]++] = i;
+  }
+  free(fill);
+
+  cells->stamp = Z_Calloc(count, sizeof(*cells->stamp), PU_LEVEL, NULL);
+  cells->result = Z_Malloc(count * sizeof(*cells->result), PU_LEVEL, NULL);
+}
+
+static void AM_initGrid(void)
+{
+  int i;
+  fixed_t box[4];
+
+  M_ClearBox(box);
+  for (i = 0; i < numvertexes; i++)
+    M_AddToBox(box, vertexes[i].x, vertexes[i].y);
+
+  Z_Calloc(1, sizeof(*amgrid), PU_LEVEL, (void **)&amgrid);
+  amgrid->x = box[BOXLEFT] >> FRACTOMAPBITS;
+  amgrid->y = box[BOXBOTTOM] >> FRACTOMAPBITS;
+  amgrid->width = (int)((((int_64_t)box[BOXRIGHT] >> FRACTOMAPBITS) - amgrid->x) >> AMGRID_SHIFT) + 1;
+  amgrid->height = (int)((((int_64_t)box[BOXTOP] >> FRACTOMAPBITS) - amgrid->y) >> AMGRID_SHIFT) + 1;
+  if (!numvertexes)
+    amgrid->width = amgrid->height = 0;
+
+  AM_gridFill(&amgrid->lines, numlines, AM_lineBox);
+  AM_gridFill(&amgrid->sectors, numsectors, AM_sectorBox);
+
+  amgrid->vertexes = Z_Malloc(numvertexes * sizeof(*amgrid->vertexes), PU_LEVEL, NULL);
+  amgrid->vertexstamp = Z_Calloc(numvertexes, sizeof(*amgrid->vertexstamp), PU_LEVEL, NULL);
+  amgrid->transformstamp = 1;
+}
+
+static int C_DECL AM_compareIndex(const void *a, const void *b)
+{
+  return *(const int *)a - *(const int *)b;
+}
+
+//
+// AM_gridQuery()
+//
+// Collects the entries of all cells touching the frame bounding box.
+// They are returned in ascending order, so drawing order is the same as
+// when walking the whole level.
+//
+
+static int AM_gridQuery(amgrid_cells_t *cells)
+{
+  int x, y, x1, x2, y1, y2, j, count = 0;
+
+  if (!AM_gridRange(am_frame.bbox, &x1, &x2, &y1, &y2))
+    return 0;
+
+  amgrid->querystamp++;
+  for (y = y1; y <= y2; y++)
+  {
+    for (x = x1; x <= x2; x++)
+    {
+      int cell = y * amgrid->width + x;
+
+      for (j = cells->start[cell]; j < cells->start[cell + 1]; j++)
+      {
+        int i = cells->list[j];
+
+        if (cells->stamp[i] != amgrid->querystamp)
+        {
+          cells->stamp[i] = amgrid->querystamp;
+          cells->result[count++] = i;
+        }
+      }
+    }
+  }
+
+  if (x1 != x2 || y1 != y2)
+    qsort(cells->result, count, sizeof(*cells->result), AM_compareIndex);
+
+  return count;
+}
+
+//
+// AM_transformVertex()
+//
+// Returns a vertex in rotated map coords, from the cache when possible.
+//
+
+static void AM_transformVertex(const vertex_t *v, mpoint_t *p)
+{
+  int i = v - vertexes;
+
+  if (amgrid->vertexstamp[i] != amgrid->transformstamp)
+  {
+    mpoint_t *c = &amgrid->vertexes[i];
+
+    c->x = v->x >> FRACTOMAPBITS;
+    c->y = v->y >> FRACTOMAPBITS;
+
+    if (automapmode & am_rotate)
+      AM_rotatePoint(c);
+    else
+      AM_SetMPointFloatValue(c);
+
+    amgrid->vertexstamp[i] = amgrid->transformstamp;
+  }
+
+  *p = amgrid->vertexes[i];
+}
+
 //
 // AM_changeWindowScale()
 //
@@ -1340,12 +1546,15 @@ static int AM_DoorColor(int type)
 //
 static void AM_drawWalls(void)
 {
-  int i;
+  int i, n, count;
   static mline_t l;
 
   // draw the unclipped visible portions of all lines
-  for (i=0;i<numlines;i++)
+  count = AM_gridQuery(&amgrid->lines);
+  for (n=0;n<count;n++)
   {
+    i = amgrid->lines.result[n];
+
     if (lines[i].bbox[BOXLEFT] >> FRACTOMAPBITS > am_frame.bbox[BOXRIGHT] ||
       lines[i].bbox[BOXRIGHT] >> FRACTOMAPBITS < am_frame.bbox[BOXLEFT] ||
       lines[i].bbox[BOXBOTTOM] >> FRACTOMAPBITS > am_frame.bbox[BOXTOP] ||
@@ -1354,21 +1563,8 @@ static void AM_drawWalls(void)
       continue;
     }
 
-    l.a.x = lines[i].v1->x >> FRACTOMAPBITS;
-    l.a.y = lines[i].v1->y >> FRACTOMAPBITS;
-    l.b.x = lines[i].v2->x >> FRACTOMAPBITS;
-    l.b.y = lines[i].v2->y >> FRACTOMAPBITS;
-
-    if (automapmode & am_rotate)
-    {
-      AM_rotatePoint(&l.a);
-      AM_rotatePoint(&l.b);
-    }
-    else
-    {
-      AM_SetMPointFloatValue(&l.a);
-      AM_SetMPointFloatValue(&l.b);
-    }
+    AM_transformVertex(lines[i].v1, &l.a);
+    AM_transformVertex(lines[i].v2, &l.b);
 
     // if line has been seen or IDDT has been used
     if (ddt_cheating || (lines[i].flags & ML_MAPPED))
@@ -1882,9 +2078,16 @@ static void AM_DrawNiceThings(void)
   // walls
   if (ddt_cheating == 2)
   {
-    // for all sectors
-    for (i = 0; i < numsectors; i++)
+    int n, count = numsectors;
+
+    if (!(players[displayplayer].cheats & CF_NOCLIP))
+      count = AM_gridQuery(&amgrid->sectors);
+
+    // for all sectors in the frame
+    for (n = 0; n < count; n++)
     {
+      i = (count == numsectors ? n : amgrid->sectors.result[n]);
+
       if (!(players[displayplayer].cheats & CF_NOCLIP) &&
         (sectors[i].bbox[BOXLEFT] > am_frame.bbox[BOXRIGHT] ||
         sectors[i].bbox[BOXRIGHT] < am_frame.bbox[BOXLEFT] ||
@@ -1961,14 +2164,17 @@ static void AM_DrawNiceThings(void)
 //
 static void AM_drawThings(void)
 {
-  int   i;
+  int   i, n, count = numsectors;
   mobj_t* t;
 
   if (ddt_cheating != 2)
     return;
 
-  // for all sectors
-  for (i=0;i<numsectors;i++)
+  if (!(players[displayplayer].cheats & CF_NOCLIP))
+    count = AM_gridQuery(&amgrid->sectors);
+
+  // for all sectors in the frame
+  for (n=0;n<count;n++)
   {
    // e6y
    // Two-pass method for better usability of automap:
@@ -1978,6 +2184,8 @@ static void AM_drawThings(void)
    int pass;
    int enemies = 0;
 
+   i = (count == numsectors ? n : amgrid->sectors.result[n]);
+
    if (!(players[displayplayer].cheats & CF_NOCLIP) &&
      (sectors[i].bbox[BOXLEFT] > am_frame.bbox[BOXRIGHT] ||
      sectors[i].bbox[BOXRIGHT] < am_frame.bbox[BOXLEFT] ||
@@ -2272,6 +2480,20 @@ static void AM_setFrameVariables(void)
   }
 
   am_frame.precise = (V_GetMode() == VID_MODEGL);
+
+  // the cached vertex transforms are stale once the view moves
+  {
+    static am_frame_t prev_frame;
+    static int prev_rotate;
+
+    if (memcmp(&prev_frame, &am_frame, sizeof(am_frame)) ||
+        prev_rotate != (automapmode & am_rotate))
+    {
+      prev_frame = am_frame;
+      prev_rotate = (automapmode & am_rotate);
+      amgrid->transformstamp++;
+    }
+  }
 }
 
 //
@@ -2299,6 +2521,9 @@ void AM_Drawer (void)
   if (m_paninc.x || m_paninc.y)
     AM_changeWindowLoc();
 
+  if (!amgrid)
+    AM_initGrid();
+
   AM_setFrameVariables();
 
   if (!(automapmode & am_overlay)) // cph - If not overlay mode, clear background for the automap
@@ -83,6 +83,21 @@ int solo_net = 0;
 
 static void D_QuitNetGame (void);
 
+#ifdef HAVE_NET
+// Incoming packets are received into, and outgoing tics and misc packets
+// built in, one buffer allocated on first use, rather than a zone block
+// per NetUpdate call.
+#define PACKETBUFFER_SIZE 10000
+static packet_header_t *packetbuffer;
+
+static packet_header_t *D_PacketBuffer(void)
+{
+  if (!packetbuffer)
+    packetbuffer = Z_Malloc(PACKETBUFFER_SIZE, PU_STATIC, NULL);
+  return packetbuffer;
+}
+#endif
+
 #ifndef HAVE_NET
 doomcom_t*      doomcom;
 #endif
@@ -272,8 +287,9 @@ void NetUpdate(void)
     return;
   if (server) { // Receive network packets
     size_t recvlen;
-    packet_header_t *packet = Z_Malloc(10000, PU_STATIC, NULL);
-    while ((recvlen = I_GetPacket(packet, 10000))) {
+    packet_header_t *packet = D_PacketBuffer();
+    dboolean missed = false;
+    while ((recvlen = I_GetPacket(packet, PACKETBUFFER_SIZE))) {
       switch(packet->type) {
       case PKT_TICS:
   {
@@ -281,9 +297,7 @@ void NetUpdate(void)
     int tics = *p++;
     unsigned long ptic = doom_ntohl(packet->tic);
     if (ptic > (unsigned)remotetic) { // Missed some
-      packet_set(packet, PKT_RETRANS, remotetic);
-      *(byte*)(packet+1) = consoleplayer;
-      I_SendPacket(packet, sizeof(*packet)+1);
+      missed = true; // one resend request covers every gap, see below
     } else {
       if (ptic + tics <= (unsigned)remotetic) break; // Will not improve things
       remotetic = ptic;
@@ -330,7 +344,14 @@ void NetUpdate(void)
   break;
       }
     }
-    Z_Free(packet);
+    if (missed) {
+      // remotetic only moves forward while receiving, so requesting
+      // from the final value once replaces a request per early packet
+      char buf[sizeof(packet_header_t)+1];
+      packet_set((packet_header_t *)buf, PKT_RETRANS, remotetic);
+      buf[sizeof(buf)-1] = consoleplayer;
+      I_SendPacket((packet_header_t *)buf, sizeof buf);
+    }
   }
   { // Build new ticcmds
     int newtics = I_GetTime() - lastmadetic;
@@ -356,7 +377,7 @@ void NetUpdate(void)
       sendtics = MIN(maketic - remotesend, 128); // limit number of sent tics (CVE-2019-20797)
       {
   size_t pkt_size = sizeof(packet_header_t) + 2 + sendtics * sizeof(ticcmd_t);
-  packet_header_t *packet = Z_Malloc(pkt_size, PU_STATIC, NULL);
+  packet_header_t *packet = D_PacketBuffer(); // 128 tics fit easily
 
   packet_set(packet, PKT_TICC, maketic - sendtics);
   *(byte*)(packet+1) = sendtics;
@@ -369,7 +390,6 @@ void NetUpdate(void)
     }
   }
   I_SendPacket(packet, pkt_size);
-  Z_Free(packet);
       }
     }
   }
@@ -397,7 +417,8 @@ void D_NetSendMisc(netmisctype_t type, size_t len, void* data)
 {
   if (server) {
     size_t size = sizeof(packet_header_t) + 3*sizeof(int) + len;
-    packet_header_t *packet = Z_Malloc(size, PU_STATIC, NULL);
+    packet_header_t *packet = size <= PACKETBUFFER_SIZE ?
+      D_PacketBuffer() : Z_Malloc(size, PU_STATIC, NULL);
     int *p = (void*)(packet+1);
 
     packet_set(packet, PKT_EXTRA, gametic);
@@ -405,7 +426,8 @@ void D_NetSendMisc(netmisctype_t type, size_t len, void* data)
     memcpy(p, data, len);
     I_SendPacket(packet, size);
 
-    Z_Free(packet);
+    if (packet != packetbuffer)
+      Z_Free(packet);
   }
 }
 
@@ -50,6 +50,8 @@
 #include "m_argv.h"
 #include "m_misc.h"
 #include "e6y.h"//e6y
+#include "i_system.h"
+#include "md5.h"
 
 #include <strings.h>
 
@@ -1587,6 +1589,552 @@ void deh_applyCompatibility(void)
   deh_changeCompTranslucency();
 }
 
+// ====================================================================
+// Compiled patch cache
+//
+// Patches loaded at startup are queued between D_BeginDehBatch and
+// D_EndDehBatch instead of being parsed one by one. The batch is keyed by
+// the MD5 of every patch, the parser settings and the unpatched tables, and
+// the tables the handlers write are kept in <exedir>/dehcache, so the next
+// launch with the same patch set restores them without parsing any text.
+// Code pointers are stored as deh_bexptrs or deh_codeptr indices and
+// strings by value.
+// ====================================================================
+
+#define DEH_CACHE_MAGIC   "DEHC"
+#define DEH_CACHE_VERSION 1
+
+typedef struct {
+  char *filename;               // NULL for lumps
+  const char *outfilename;
+  int lumpnum;
+} deh_queued_t;
+
+static dboolean deh_batch;
+static deh_queued_t *deh_queue;
+static int deh_numqueued, deh_maxqueued;
+static dboolean deh_nocache;    // a patch INCLUDEs files we did not hash
+
+// e6y: sprites, sounds and music renamed by a Text block, see deh_procText
+static dboolean sprnames_state[NUMSPRITES+1];
+static dboolean S_sfx_state[NUMSFX];
+static dboolean S_music_state[NUMMUSIC];
+
+static int *const deh_cache_ints[] = {
+  &initial_health, &initial_bullets, &deh_maxhealth, &max_armor,
+  &green_armor_class, &blue_armor_class, &deh_max_soul, &soul_health,
+  &deh_mega_health, &god_health, &idfa_armor, &idfa_armor_class,
+  &idkfa_armor, &idkfa_armor_class, &bfgcells, &monsters_infight,
+  &HelperThing,
+};
+
+static dboolean *const deh_cache_bools[] = {
+  &IsDehMaxHealth, &IsDehMaxSoul, &IsDehMegaHealth, &deh_pars,
+};
+
+#define DEH_CACHE_INTS  (sizeof(deh_cache_ints)/sizeof(*deh_cache_ints))
+#define DEH_CACHE_BOOLS (sizeof(deh_cache_bools)/sizeof(*deh_cache_bools))
+#define DEH_NUMBEXPTRS  (sizeof(deh_bexptrs)/sizeof(*deh_bexptrs))
+
+typedef struct {
+  byte *data;
+  size_t size, maxsize;
+} deh_cachebuf_t;
+
+typedef struct {
+  const byte *p, *end;
+} deh_cacheread_t;
+
+static void deh_CachePut(deh_cachebuf_t *buf, const void *p, size_t len)
+{
+  if (buf->size + len > buf->maxsize)
+  {
+    buf->maxsize = MAX(buf->maxsize * 2, buf->size + len);
+    buf->data = realloc(buf->data, buf->maxsize);
+  }
+  memcpy(buf->data + buf->size, p, len);
+  buf->size += len;
+}
+
+static void deh_CachePutString(deh_cachebuf_t *buf, const char *s)
+{
+  int len = s ? strlen(s) : -1;
+
+  deh_CachePut(buf, &len, sizeof(len));
+  if (s)
+    deh_CachePut(buf, s, len + 1);
+}
+
+// Reads len bytes into dest, or skips them if dest is NULL
+static dboolean deh_CacheGet(deh_cacheread_t *r, void *dest, size_t len)
+{
+  if ((size_t)(r->end - r->p) < len)
+    return false;
+  if (dest)
+    memcpy(dest, r->p, len);
+  r->p += len;
+  return true;
+}
+
+static dboolean deh_CacheGetString(deh_cacheread_t *r, const char **s)
+{
+  int len;
+
+  if (!deh_CacheGet(r, &len, sizeof(len)))
+    return false;
+  *s = NULL;
+  if (len < 0)
+    return true;
+  if ((size_t)(r->end - r->p) <= (size_t)len || r->p[len])
+    return false;
+  *s = (const char *)r->p;
+  r->p += len + 1;
+  return true;
+}
+
+// Only replaces strings that differ, so untouched ones keep pointing
+// at their literals like they do after a parse
+static void deh_CacheSetString(const char **dest, const char *s)
+{
+  if (s != *dest && (!s || !*dest || strcmp(s, *dest)))
+    *dest = s ? strdup(s) : NULL;
+}
+
+//
+// deh_WriteCacheTables
+//
+// Serializes everything the deh_proc* handlers can change. Returns false
+// if a state uses a code pointer a patch could not have assigned.
+//
+
+static dboolean deh_WriteCacheTables(deh_cachebuf_t *buf)
+{
+  int ints[DEH_CACHE_INTS + DEH_CACHE_BOOLS];
+  int i, j;
+
+  for (i = 0; i < NUMSTATES; i++)
+  {
+    long st[7];
+
+    for (j = 0; deh_bexptrs[j].cptr != states[i].action; j++)
+      if (!deh_bexptrs[j].cptr)
+        break;
+
+    // pointers without a mnemonic can only come from deh_codeptr
+    if (deh_bexptrs[j].cptr != states[i].action)
+    {
+      for (j = 0; j < NUMSTATES && deh_codeptr[j] != states[i].action; j++)
+        ;
+      if (j == NUMSTATES)
+        return false;
+      j += DEH_NUMBEXPTRS;
+    }
+
+    st[0] = states[i].sprite;
+    st[1] = states[i].frame;
+    st[2] = states[i].tics;
+    st[3] = j;
+    st[4] = states[i].nextstate;
+    st[5] = states[i].misc1;
+    st[6] = states[i].misc2;
+    deh_CachePut(buf, st, sizeof(st));
+  }
+
+  deh_CachePut(buf, mobjinfo, sizeof(mobjinfo));
+  deh_CachePut(buf, DEH_mobjinfo_bits, sizeof(DEH_mobjinfo_bits));
+  deh_CachePut(buf, weaponinfo, sizeof(weaponinfo));
+  deh_CachePut(buf, maxammo, NUMAMMO * sizeof(*maxammo));
+  deh_CachePut(buf, clipammo, NUMAMMO * sizeof(*clipammo));
+  deh_CachePut(buf, pars, sizeof(pars));
+  deh_CachePut(buf, cpars, 32 * sizeof(*cpars)); // MAP01-MAP32, see deh_procPars
+
+  for (i = 0; i < (int)DEH_CACHE_INTS; i++)
+    ints[i] = *deh_cache_ints[i];
+  for (i = 0; i < (int)DEH_CACHE_BOOLS; i++)
+    ints[DEH_CACHE_INTS + i] = *deh_cache_bools[i];
+  deh_CachePut(buf, ints, sizeof(ints));
+
+  for (i = 0; i < NUMSFX; i++)
+  {
+    int sfx[6];
+
+    sfx[0] = S_sfx[i].singularity;
+    sfx[1] = S_sfx[i].priority;
+    sfx[2] = S_sfx[i].pitch;
+    sfx[3] = S_sfx[i].volume;
+    sfx[4] = S_sfx[i].usefulness;
+    sfx[5] = S_sfx[i].lumpnum;
+    deh_CachePut(buf, sfx, sizeof(sfx));
+    deh_CachePutString(buf, S_sfx[i].name);
+  }
+
+  for (i = 0; i < NUMMUSIC; i++)
+    deh_CachePutString(buf, S_music[i].name);
+  for (i = 0; i < NUMSPRITES; i++)
+    deh_CachePutString(buf, sprnames[i]);
+  for (i = 0; i < deh_numstrlookup; i++)
+    deh_CachePutString(buf, *deh_strlookup[i].ppstr);
+
+  for (j = 0; cheat[j].cheat; j++)
+    ;
+  deh_CachePut(buf, &j, sizeof(j));
+  for (i = 0; i < j; i++)
+    deh_CachePutString(buf, cheat[i].cheat);
+
+  deh_CachePut(buf, sprnames_state, sizeof(sprnames_state));
+  deh_CachePut(buf, S_sfx_state, sizeof(S_sfx_state));
+  deh_CachePut(buf, S_music_state, sizeof(S_music_state));
+
+  return true;
+}
+
+//
+// deh_ReadCacheTables
+//
+// Mirror of deh_WriteCacheTables. With apply false it only checks that the
+// data is complete, so a bad entry never leaves the tables half restored.
+//
+
+static dboolean deh_ReadCacheTables(const byte *data, size_t size, dboolean apply)
+{
+  deh_cacheread_t r;
+  int ints[DEH_CACHE_INTS + DEH_CACHE_BOOLS];
+  const char *s;
+  int i, count;
+
+  r.p = data;
+  r.end = data + size;
+
+  for (i = 0; i < NUMSTATES; i++)
+  {
+    long st[7];
+
+    if (!deh_CacheGet(&r, st, sizeof(st)) ||
+        st[3] < 0 || st[3] >= (long)DEH_NUMBEXPTRS + NUMSTATES)
+      return false;
+
+    if (apply)
+    {
+      states[i].sprite = (spritenum_t)st[0];
+      states[i].frame = st[1];
+      states[i].tics = st[2];
+      states[i].action = st[3] < (long)DEH_NUMBEXPTRS ?
+        deh_bexptrs[st[3]].cptr : deh_codeptr[st[3] - DEH_NUMBEXPTRS];
+      states[i].nextstate = (statenum_t)st[4];
+      states[i].misc1 = st[5];
+      states[i].misc2 = st[6];
+    }
+  }
+
+  if (!deh_CacheGet(&r, apply ? mobjinfo : NULL, sizeof(mobjinfo)) ||
+      !deh_CacheGet(&r, apply ? DEH_mobjinfo_bits : NULL, sizeof(DEH_mobjinfo_bits)) ||
+      !deh_CacheGet(&r, apply ? weaponinfo : NULL, sizeof(weaponinfo)) ||
+      !deh_CacheGet(&r, apply ? maxammo : NULL, NUMAMMO * sizeof(*maxammo)) ||
+      !deh_CacheGet(&r, apply ? clipammo : NULL, NUMAMMO * sizeof(*clipammo)) ||
+      !deh_CacheGet(&r, apply ? pars : NULL, sizeof(pars)) ||
+      !deh_CacheGet(&r, apply ? cpars : NULL, 32 * sizeof(*cpars)) ||
+      !deh_CacheGet(&r, ints, sizeof(ints)))
+    return false;
+
+  if (apply)
+  {
+    for (i = 0; i < (int)DEH_CACHE_INTS; i++)
+      *deh_cache_ints[i] = ints[i];
+    for (i = 0; i < (int)DEH_CACHE_BOOLS; i++)
+      *deh_cache_bools[i] = ints[DEH_CACHE_INTS + i];
+  }
+
+  for (i = 0; i < NUMSFX; i++)
+  {
+    int sfx[6];
+
+    if (!deh_CacheGet(&r, sfx, sizeof(sfx)) || !deh_CacheGetString(&r, &s))
+      return false;
+
+    if (apply)
+    {
+      S_sfx[i].singularity = sfx[0];
+      S_sfx[i].priority = sfx[1];
+      S_sfx[i].pitch = sfx[2];
+      S_sfx[i].volume = sfx[3];
+      S_sfx[i].usefulness = sfx[4];
+      S_sfx[i].lumpnum = sfx[5];
+      deh_CacheSetString(&S_sfx[i].name, s);
+    }
+  }
+
+  for (i = 0; i < NUMMUSIC; i++)
+  {
+    if (!deh_CacheGetString(&r, &s))
+      return false;
+    if (apply)
+      deh_CacheSetString(&S_music[i].name, s);
+  }
+
+  for (i = 0; i < NUMSPRITES; i++)
+  {
+    if (!deh_CacheGetString(&r, &s) || (apply && !s))
+      return false;
+    if (apply)
+      deh_CacheSetString(&sprnames[i], s);
+  }
+
+  for (i = 0; i < deh_numstrlookup; i++)
+  {
+    if (!deh_CacheGetString(&r, &s) || !s)
+      return false;
+    if (apply && strcmp(s, *deh_strlookup[i].ppstr))
+    {
+      if (deh_strlookup[i].orig == NULL)
+        deh_strlookup[i].orig = *deh_strlookup[i].ppstr;
+      *deh_strlookup[i].ppstr = strdup(s);
+    }
+  }
+
+  if (!deh_CacheGet(&r, &count, sizeof(count)))
+    return false;
+  for (i = 0; i < count; i++)
+    if (!cheat[i].cheat)
+      return false;
+  if (cheat[count].cheat)
+    return false;
+  for (i = 0; i < count; i++)
+  {
+    if (!deh_CacheGetString(&r, &s) || !s)
+      return false;
+    if (apply)
+      deh_CacheSetString(&cheat[i].cheat, s);
+  }
+
+  return
+    deh_CacheGet(&r, apply ? sprnames_state : NULL, sizeof(sprnames_state)) &&
+    deh_CacheGet(&r, apply ? S_sfx_state : NULL, sizeof(S_sfx_state)) &&
+    deh_CacheGet(&r, apply ? S_music_state : NULL, sizeof(S_music_state)) &&
+    r.p == r.end;
+}
+
+static char *deh_CacheName(const unsigned char *digest)
+{
+  const char *exedir = I_DoomExeDir();
+  char *name, *p;
+  int i, len;
+
+  len = doom_snprintf(NULL, 0, "%s/dehcache", exedir);
+  name = malloc(len + 1 + 32 + 4 + 1);
+  doom_snprintf(name, len + 1, "%s/dehcache", exedir);
+  M_mkdir(name);
+
+  p = name + len;
+  *p++ = '/';
+  for (i = 0; i < 16; i++)
+    p += sprintf(p, "%02x", digest[i]);
+  strcpy(p, ".deh");
+
+  return name;
+}
+
+//
+// deh_CacheKey
+//
+// Hashes the unpatched tables in buf, the settings the handlers read and
+// the contents of every queued patch.
+//
+
+static void deh_CacheKey(const deh_cachebuf_t *buf, unsigned char *digest)
+{
+  struct MD5Context md5;
+  int settings[5];
+  int i;
+
+  settings[0] = DEH_CACHE_VERSION;
+  settings[1] = compatibility_level;
+  settings[2] = prboom_comp[PC_FORCE_INCORRECT_PROCESSING_OF_RESPAWN_FRAME_ENTRY].state;
+  settings[3] = deh_apply_cheats && !M_CheckParm("-nocheats");
+  settings[4] = deh_numqueued;
+
+  MD5Init(&md5);
+  MD5Update(&md5, (md5byte const *)settings, sizeof(settings));
+  MD5Update(&md5, buf->data, buf->size);
+
+  for (i = 0; i < deh_numqueued; i++)
+  {
+    const deh_queued_t *q = &deh_queue[i];
+    int header[2];
+
+    if (q->filename)
+    {
+      byte *data = NULL;
+
+      header[0] = -1;
+      header[1] = M_ReadFile(q->filename, &data);
+      MD5Update(&md5, (md5byte const *)header, sizeof(header));
+      if (data)
+      {
+        MD5Update(&md5, data, header[1]);
+        free(data);
+      }
+    }
+    else
+    {
+      header[0] = q->lumpnum;
+      header[1] = W_LumpLength(q->lumpnum);
+      MD5Update(&md5, (md5byte const *)header, sizeof(header));
+      if (header[1] > 0)
+      {
+        MD5Update(&md5, W_CacheLumpNum(q->lumpnum), header[1]);
+        W_UnlockLumpNum(q->lumpnum);
+      }
+    }
+  }
+
+  MD5Final(digest, &md5);
+}
+
+static dboolean deh_LoadCache(const char *name)
+{
+  struct MD5Context md5;
+  unsigned char digest[16];
+  byte *data = NULL;
+  int len, size;
+  dboolean result = false;
+
+  len = M_ReadFile(name, &data);
+  if (len < 4 + (int)sizeof(size) + 16)
+  {
+    free(data);
+    return false;
+  }
+
+  memcpy(&size, data + 4, sizeof(size));
+  if (!memcmp(data, DEH_CACHE_MAGIC, 4) && size == len - 4 - (int)sizeof(size) - 16)
+  {
+    const byte *body = data + 4 + sizeof(size) + 16;
+
+    MD5Init(&md5);
+    MD5Update(&md5, body, size);
+    MD5Final(digest, &md5);
+
+    if (!memcmp(digest, data + 4 + sizeof(size), 16) &&
+        deh_ReadCacheTables(body, size, false))
+      result = deh_ReadCacheTables(body, size, true);
+  }
+
+  free(data);
+  return result;
+}
+
+static void deh_SaveCache(const char *name, const deh_cachebuf_t *buf)
+{
+  struct MD5Context md5;
+  unsigned char digest[16];
+  int size = buf->size;
+  FILE *f;
+  dboolean ok;
+
+  MD5Init(&md5);
+  MD5Update(&md5, buf->data, buf->size);
+  MD5Final(digest, &md5);
+
+  if (!(f = M_fopen(name, "wb")))
+    return;
+
+  ok = fwrite(DEH_CACHE_MAGIC, 4, 1, f) == 1 &&
+    fwrite(&size, sizeof(size), 1, f) == 1 &&
+    fwrite(digest, 16, 1, f) == 1 &&
+    fwrite(buf->data, buf->size, 1, f) == 1;
+
+  fclose(f);
+
+  // don't leave a truncated entry behind
+  if (!ok)
+    M_remove(name);
+}
+
+static void D_QueueDehPatch(const char *filename, const char *outfilename, int lumpnum)
+{
+  deh_queued_t *q;
+
+  if (deh_numqueued == deh_maxqueued)
+  {
+    deh_maxqueued = deh_maxqueued ? deh_maxqueued * 2 : 8;
+    deh_queue = realloc(deh_queue, deh_maxqueued * sizeof(*deh_queue));
+  }
+
+  q = &deh_queue[deh_numqueued++];
+  q->filename = filename ? strdup(filename) : NULL;
+  q->outfilename = outfilename;
+  q->lumpnum = lumpnum;
+}
+
+void D_BeginDehBatch(void)
+{
+  deh_batch = true;
+}
+
+//
+// D_EndDehBatch
+//
+// Applies the queued patches in order, from the cache if it has this
+// patch set. -dehout needs the parser's log, so it always parses.
+//
+
+void D_EndDehBatch(void)
+{
+  deh_cachebuf_t buf = {NULL, 0, 0};
+  char *name = NULL;
+  int i;
+
+  deh_batch = false;
+
+  if (!deh_numqueued)
+    return;
+
+  if (!M_CheckParm("-nodehcache"))
+  {
+    for (i = 0; i < deh_numqueued; i++)
+      if (deh_queue[i].outfilename && *deh_queue[i].outfilename)
+        break;
+
+    if (i == deh_numqueued && deh_WriteCacheTables(&buf))
+    {
+      unsigned char digest[16];
+
+      deh_CacheKey(&buf, digest);
+      name = deh_CacheName(digest);
+    }
+  }
+
+  if (name && deh_LoadCache(name))
+  {
+    lprintf(LO_INFO, "Loaded %d DEH patch%s from cache\n",
+            deh_numqueued, deh_numqueued == 1 ? "" : "es");
+    deh_applyCompatibility();
+  }
+  else
+  {
+    deh_nocache = false;
+
+    for (i = 0; i < deh_numqueued; i++)
+      ProcessDehFile(deh_queue[i].filename, deh_queue[i].outfilename, deh_queue[i].lumpnum);
+
+    if (name && !deh_nocache)
+    {
+      buf.size = 0;
+      if (deh_WriteCacheTables(&buf))
+        deh_SaveCache(name, &buf);
+    }
+  }
+
+  for (i = 0; i < deh_numqueued; i++)
+    free(deh_queue[i].filename);
+  free(deh_queue);
+  deh_queue = NULL;
+  deh_numqueued = deh_maxqueued = 0;
+
+  free(buf.data);
+  free(name);
+}
+
 // ====================================================================
 // ProcessDehFile
 // Purpose: Read and process a DEH or BEX file
@@ -1606,6 +2154,13 @@ void ProcessDehFile(const char *filename, const char *outfilename, int lumpnum)
   static unsigned last_i;
   static long filepos;
 
+  // startup patches are applied together by D_EndDehBatch
+  if (deh_batch)
+  {
+    D_QueueDehPatch(filename, outfilename, lumpnum);
+    return;
+  }
+
   // Open output file if we're writing output
   if (outfilename && *outfilename && !fileout)
     {
@@ -1705,6 +2260,7 @@ void ProcessDehFile(const char *filename, const char *outfilename, int lumpnum)
           // Second argument must be NULL to prevent closing fileout too soon
 
           ProcessDehFile(nextfile,NULL,0); // do the included file
+          deh_nocache = true;
 
           includenotext = oldnotext;
           if (fileout) fprintf(fileout,"...continuing with %s\n",filename);
@@ -2711,9 +3267,8 @@ static void deh_procText(DEHFILE *fpin, FILE* fpout, char *line)
   // BOSSBOS2  BOS2BOSS;   RUNNINSTALKS  STALKSRUNNIN
   // It corrects buggy behaviour on "All Hell is Breaking Loose" TC
   // http://www.doomworld.com/idgames/index.php?id=6480 
-  static dboolean sprnames_state[NUMSPRITES+1];
-  static dboolean S_sfx_state[NUMSFX];
-  static dboolean S_music_state[NUMMUSIC];
+  // The sprnames_state, S_sfx_state and S_music_state flags live at file
+  // scope so the patch cache can store them.
 
   // Ty 04/11/98 - Included file may have NOTEXT skip flag set
   if (includenotext) // flag to skip included deh-style text
@@ -1120,6 +1120,8 @@ extern const char* startup5;
 extern const char* savegamename;
 
 void D_BuildBEXTables(void);
+void D_BeginDehBatch(void);
+void D_EndDehBatch(void);
 void deh_changeCompTranslucency(void);
 void deh_applyCompatibility(void);
 
@@ -496,11 +496,15 @@ void D_Display (fixed_t frac)
 
   // normal update
   if (!wipe)
+  {
+    R_PaceFrame();                  // hold uncapped frames to their deadline
     I_FinishUpdate ();              // page flip or blit buffer
+  }
   else {
     // wipe update
     wipe_EndScreen();
     D_Wipe(num_eyes);
+    R_ResetFramePacer();
   }
 
   // e6y
@@ -745,6 +749,7 @@ void D_DoAdvanceDemo(void)
 //
 void D_StartTitle (void)
 {
+  P_ReleasePreload();
   gameaction = ga_nothing;
   demosequence = -1;
   D_AdvanceDemo();
@@ -2016,6 +2021,10 @@ static void D_DoomMainSetup(void)
 
   lprintf(LO_INFO,"\n");     // killough 3/6/98: add a newline, by popular demand :)
 
+  // startup patches are queued and applied by D_EndDehBatch, which can
+  // restore the whole set from the compiled patch cache
+  D_BeginDehBatch();
+
   // e6y 
   // option to disable automatic loading of dehacked-in-wad lump
   if (!M_CheckParm ("-nodeh"))
@@ -2133,6 +2142,8 @@ static void D_DoomMainSetup(void)
     }
   }
 
+  D_EndDehBatch();
+
   if (!M_CheckParm("-nomapinfo"))
   {
 	  int p;
@@ -41,6 +41,7 @@
 #include "sounds.h"
 #include "d_deh.h"  // Ty 03/22/98 - externalizations
 #include "f_finale.h" // CPhipps - hmm...
+#include "p_setup.h"
 
 
 // The implementation for UMAPINFO is kept separate to avoid demo sync issues
@@ -84,6 +85,8 @@ void F_StartFinale (void)
   gamestate = GS_FINALE;
   automapmode &= ~am_active;
 
+  P_ReleasePreload();         // the finale may not lead to the next map
+
   // killough 3/28/98: clear accelerative text flags
   acceleratestage = midstage = 0;
 
@@ -256,6 +256,7 @@ int wipe_ScreenWipe(int ticks, int num_eyes)
 {
   static dboolean go;                               // when zero, stop the wipe
   if(!render_wipescreen) return 0;//e6y
+  V_MarkScreenDirty();
   if (!go)                                         // initial stuff
     {
       go = 1;
@@ -0,0 +1,147 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *   Buffered demo recording with checkpoints.
+ *
+ *   Recorded tics are collected here and written out every
+ *   DEMO_FLUSH_TICS. Each write is followed by the end of the demo, so
+ *   the file on disk is always a complete demo at most that far behind.
+ *   The end is then stepped over, and the next tics overwrite it.
+ *
+ *   The file only grows from one checkpoint to the next, because the tic
+ *   data and the footer's mouselook lump only grow. So a checkpoint never
+ *   leaves stale bytes behind, and the file matches what an unbuffered
+ *   writer stopped at the same tic would have written.
+ *   tests/test_demobuf.c checks this on the host.
+ *
+ *---------------------------------------------------------------------
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "doomdef.h"
+#include "lprintf.h"
+#include "g_demobuf.h"
+
+// a tic is at most 5 bytes per player, so DEMO_FLUSH_TICS always fit and
+// checkpoints land between tics
+#define DEMO_BUFFER_SIZE ((DEMO_FLUSH_TICS+1)*MAXPLAYERS*5)
+
+static byte       demo_buffer[DEMO_BUFFER_SIZE];
+static size_t     demo_buffered;
+static int        demo_lastflush;
+static FILE       *demo_file;
+static demo_end_f demo_writeend;
+
+//
+// G_DemoBufferStart
+// Starts buffering for a demo recorded to file, whose header is written,
+// with a checkpoint so the file is a complete demo right away.
+//
+
+void G_DemoBufferStart(FILE *file, demo_end_f writeend, int tic)
+{
+  demo_file = file;
+  demo_writeend = writeend;
+  demo_buffered = 0;
+  demo_lastflush = tic;
+
+  G_DemoBufferFlush(true);
+}
+
+//
+// G_DemoBufferFlush
+// Writes out the buffered tics. A checkpoint also ends the demo and steps
+// back over the end.
+//
+
+void G_DemoBufferFlush(dboolean checkpoint)
+{
+  long pos;
+
+  if (!demo_file)
+    return;
+
+  if (demo_buffered &&
+      fwrite(demo_buffer, demo_buffered, 1, demo_file) != 1)
+    I_Error("G_DemoBufferFlush: error writing demo");
+
+  demo_buffered = 0;
+
+  if (!checkpoint)
+    return;
+
+  pos = ftell(demo_file);
+  demo_writeend(demo_file);
+  fflush(demo_file);
+  fseek(demo_file, pos, SEEK_SET);
+}
+
+//
+// G_DemoBufferStop
+// Writes out the buffered tics and ends the demo. Flushes do nothing
+// until the next G_DemoBufferStart.
+//
+
+void G_DemoBufferStop(void)
+{
+  if (!demo_file)
+    return;
+
+  G_DemoBufferFlush(false);
+  demo_writeend(demo_file);
+  demo_file = NULL;
+}
+
+//
+// G_DemoBufferWrite
+// Adds the encoded ticcmd of one player, checkpointing first if the last
+// checkpoint is DEMO_FLUSH_TICS old. Returns the buffered copy.
+//
+
+const byte *G_DemoBufferWrite(const byte *data, size_t size, int tic)
+{
+  byte *p;
+
+  // a loaded game can move tic back, which also restarts the interval
+  if (demo_buffered + size > DEMO_BUFFER_SIZE ||
+      tic - demo_lastflush >= DEMO_FLUSH_TICS || tic < demo_lastflush)
+  {
+    G_DemoBufferFlush(true);
+    demo_lastflush = tic;
+  }
+
+  p = demo_buffer + demo_buffered;
+  memcpy(p, data, size);
+  demo_buffered += size;
+
+  return p;
+}
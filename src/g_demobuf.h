@@ -0,0 +1,53 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *   Buffered demo recording with checkpoints.
+ *
+ *---------------------------------------------------------------------
+ */
+
+#ifndef __G_DEMOBUF__
+#define __G_DEMOBUF__
+
+#include <stdio.h>
+#include "doomdef.h"
+
+// the file on disk is at most this many tics behind the game
+#define DEMO_FLUSH_TICS (5*TICRATE)
+
+// Writes the end of a demo, a DEMOMARKER and the footer, at the current
+// position of the file.
+typedef void (*demo_end_f)(FILE *file);
+
+void G_DemoBufferStart(FILE *file, demo_end_f writeend, int tic);
+const byte *G_DemoBufferWrite(const byte *data, size_t size, int tic);
+void G_DemoBufferFlush(dboolean checkpoint);
+void G_DemoBufferStop(void);
+
+#endif
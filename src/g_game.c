@@ -84,6 +84,7 @@
 #include "i_main.h"
 #include "i_system.h"
 #include "r_demo.h"
+#include "g_demobuf.h"
 #include "r_fps.h"
 #include "e6y.h"//e6y
 #include "statdump.h"
@@ -909,6 +910,7 @@ static void G_DoLoadLevel (void)
   P_FreeSecNodeList();
 
   P_SetupLevel (gameepisode, gamemap, 0, gameskill);
+  R_ResetFramePacer(); // the load is not a frame
   if (!demoplayback) // Don't switch views if playing a demo
     displayplayer = consoleplayer;    // view the guy you are playing
   gameaction = ga_nothing;
@@ -937,6 +939,7 @@ static void G_DoLoadLevel (void)
       if (first)
         {
           starttime = I_GetTime_RealTime ();
+          R_ResetFrameStats(&frame_stats_run);
           first=0;
         }
     }
@@ -1335,6 +1338,7 @@ void G_Ticker (void)
 
     case GS_INTERMISSION:
        WI_Ticker ();
+       P_PreloadTicker();
       break;
 
     case GS_FINALE:
@@ -1877,6 +1881,7 @@ frommapinfo:
   }
 
   WI_Start (&wminfo);
+  P_PreloadLevel(wminfo.nextep + 1, wminfo.next + 1);
 }
 
 //
@@ -3104,13 +3109,29 @@ void G_ReadDemoTiccmd (ticcmd_t* cmd)
   }
 }
 
+// ends a recorded demo, for g_demobuf.c
+static void G_WriteDemoEnd(FILE *file)
+{
+  fputc(DEMOMARKER, file);
+
+  //e6y
+  G_WriteDemoFooter(file);
+}
+
+// keeps the buffered tics if the game exits on an error
+static void G_DemoRecordingAtExit(void)
+{
+  if (demorecording)
+    G_DemoBufferFlush(true);
+}
+
 /* Demo limits removed -- killough
  * cph - record straight to file
  */
 void G_WriteDemoTiccmd (ticcmd_t* cmd)
 {
-  char buf[5];
-  char *p = buf;
+  byte buf[5];
+  byte *p = buf;
 
   if (compatibility_level == tasdoom_compatibility)
   {
@@ -3133,11 +3154,8 @@ void G_WriteDemoTiccmd (ticcmd_t* cmd)
 
   }//e6y
 
-  if (fwrite(buf, p-buf, 1, demofp) != 1)
-    I_Error("G_WriteDemoTiccmd: error writing demo");
-
   /* cph - alias demo_p to it so we can read it back */
-  demo_p = buf;
+  demo_p = G_DemoBufferWrite(buf, p - buf, gametic);
   G_ReadDemoTiccmd (cmd);         // make SURE it is exactly the same
 }
 
@@ -3155,6 +3173,14 @@ void G_RecordDemo (const char* name)
   AddDefaultExtension(strcpy(demoname, name), ".lmp");  // 1/18/98 killough
   demorecording = true;
 
+  {
+    static dboolean atexit_set;
+
+    if (!atexit_set)
+      I_AtExit(G_DemoRecordingAtExit, true);
+    atexit_set = true;
+  }
+
   if (demoname)
   {
     free(demo_filename);
@@ -3239,6 +3265,7 @@ void G_RecordDemo (const char* name)
         {
           /* Return to the last save position, and load the relevant savegame */
           fseek(demofp, -rc, SEEK_CUR);
+          G_DemoBufferStart(demofp, G_WriteDemoEnd, gametic);
           G_LoadGame(slot, false);
           autostart = false;
           return;
@@ -3644,7 +3671,9 @@ void G_BeginRecording (void)
   if (fwrite(demostart, 1, demo_p-demostart, demofp) != (size_t)(demo_p-demostart))
     I_Error("G_BeginRecording: Error writing demo header");
 
+  // the first checkpoint must not carry the last demo's mouselook
   R_DemoEx_ResetMLook();
+  G_DemoBufferStart(demofp, G_WriteDemoEnd, gametic);
 
   doom_printf("Demo recording: %s", demo_filename ? demo_filename : "(unknown)");
   free(demostart);
@@ -4341,10 +4370,7 @@ dboolean G_CheckDemoStatus (void)
   if (demorecording)
     {
       demorecording = false;
-      fputc(DEMOMARKER, demofp);
-
-      //e6y
-      G_WriteDemoFooter(demofp);
+      G_DemoBufferStop();
       fclose(demofp);
 
       lprintf(LO_INFO, "G_CheckDemoStatus: Demo recorded\n");
@@ -4359,9 +4385,13 @@ dboolean G_CheckDemoStatus (void)
 
       M_SaveDefaults();
 
-      I_Error ("Timed %u gametics in %u realtics = %-.1f frames per second",
+      I_Error ("Timed %u gametics in %u realtics = %-.1f frames per second\n"
+               "Frame time p50 %.2f ms, p99 %.2f ms, max %.2f ms over %u frames",
                (unsigned) gametic,realtics,
-               (unsigned) gametic * (double) TICRATE / realtics);
+               (unsigned) gametic * (double) TICRATE / realtics,
+               R_FrameStatsPercentile(&frame_stats_run, 50) / 1000.0,
+               R_FrameStatsPercentile(&frame_stats_run, 99) / 1000.0,
+               frame_stats_run.max_us / 1000.0, frame_stats_run.count);
     }
 
   if (demoplayback)
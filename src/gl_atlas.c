@@ -0,0 +1,282 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *   Texture atlas for small 2D patches (HUD, fonts, status bar, weapon).
+ *
+ *   Patches are packed onto a few shared pages with a shelf allocator, so
+ *   consecutive HUD draws mostly hit the same GL texture and no VRAM is
+ *   lost to power-of-two padding. A page remembers which texture id slots
+ *   point at it; when every page is full the least recently used page is
+ *   wiped and those slots are zeroed, so their patches get packed again on
+ *   the next bind. The shelf packer is in gl_shelfpack.c.
+ *
+ *---------------------------------------------------------------------
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gl_opengl.h"
+
+#include "z_zone.h"
+#include <string.h>
+#include "doomtype.h"
+#include "r_main.h"
+#include "gl_intern.h"
+#include "gl_struct.h"
+#include "gl_shelfpack.h"
+#include "lprintf.h"
+
+#ifdef GL_DOOM
+
+int gl_texture_atlas;
+
+typedef struct
+{
+  GLuint texid;
+  int lastused;         // atlas_frame of the last bind
+
+  shelfpack_t pack;
+
+  GLuint **slots;       // glTexExID entries that point at this page
+  int numslots, maxslots;
+} atlas_page_t;
+
+static atlas_page_t atlas_pages[GL_ATLAS_PAGES];
+static int atlas_frame;
+
+static void gld_AtlasResetPage(atlas_page_t *page)
+{
+  int i;
+
+  for (i = 0; i < page->numslots; i++)
+    *page->slots[i] = 0;
+
+  page->numslots = 0;
+  gld_ShelfPackReset(&page->pack);
+}
+
+static void gld_AtlasAddSlot(atlas_page_t *page, GLuint *slot)
+{
+  if (page->numslots == page->maxslots)
+  {
+    page->maxslots = page->maxslots ? page->maxslots * 2 : 64;
+    page->slots = realloc(page->slots, page->maxslots * sizeof(page->slots[0]));
+  }
+  page->slots[page->numslots++] = slot;
+}
+
+static void gld_AtlasCreatePage(atlas_page_t *page)
+{
+  unsigned char *blank = calloc(1, GL_ATLAS_PAGE_SIZE * GL_ATLAS_PAGE_SIZE * 4);
+
+  glGenTextures(1, &page->texid);
+  glBindTexture(GL_TEXTURE_2D, page->texid);
+  glTexImage2D(GL_TEXTURE_2D, 0, gl_tex_format,
+    GL_ATLAS_PAGE_SIZE, GL_ATLAS_PAGE_SIZE,
+    0, GL_RGBA, GL_UNSIGNED_BYTE, blank);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, tex_filter[MIP_PATCH].mag_filter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, tex_filter[MIP_PATCH].mag_filter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+
+  free(blank);
+}
+
+//
+// gld_AtlasAddPatch
+//
+// Packs the patch in buffer (buffer_width x buffer_height RGBA) for the
+// current colormap slot of gltexture and leaves its page bound. Returns false
+// if it doesn't fit anywhere without evicting a page drawn from this frame,
+// the caller gives the patch its own texture then.
+//
+
+dboolean gld_AtlasAddPatch(GLTexture *gltexture, const unsigned char *buffer)
+{
+  atlas_page_t *page = NULL;
+  int width = gltexture->buffer_width;
+  int height = gltexture->buffer_height;
+  int i, x, y;
+
+  gltexture->atlaspos[gltexture->texid_p - gltexture->glTexExID[0][0]] = 0;
+
+  for (i = 0; i < GL_ATLAS_PAGES; i++)
+  {
+    if (gld_ShelfPack(&atlas_pages[i].pack, GL_ATLAS_PAGE_SIZE,
+        width + GL_ATLAS_PADDING, height + GL_ATLAS_PADDING, &x, &y))
+    {
+      page = &atlas_pages[i];
+      break;
+    }
+  }
+
+  if (!page)
+  {
+    // evict the least recently used page
+    for (i = 0; i < GL_ATLAS_PAGES; i++)
+    {
+      if (atlas_pages[i].lastused != atlas_frame &&
+          (!page || atlas_pages[i].lastused < page->lastused))
+        page = &atlas_pages[i];
+    }
+
+    if (!page)
+      return false;
+
+    gld_AtlasResetPage(page);
+    gld_ResetLastTexture();
+
+    if (!gld_ShelfPack(&page->pack, GL_ATLAS_PAGE_SIZE,
+        width + GL_ATLAS_PADDING, height + GL_ATLAS_PADDING, &x, &y))
+      return false;
+  }
+
+  if (!page->texid)
+    gld_AtlasCreatePage(page);
+  else
+    glBindTexture(GL_TEXTURE_2D, page->texid);
+
+  glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+    GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+
+  page->lastused = atlas_frame;
+  *gltexture->texid_p = page->texid;
+  gltexture->atlaspos[gltexture->texid_p - gltexture->glTexExID[0][0]] =
+    (x + 1) | (y << 16);
+  gld_AtlasAddSlot(page, gltexture->texid_p);
+
+  return true;
+}
+
+//
+// gld_AtlasSetCoords
+//
+// Sets the UV origin and size for the current slot of gltexture.
+// Slots that are not on a page use the whole texture.
+//
+
+void gld_AtlasSetCoords(GLTexture *gltexture)
+{
+  int pos = gltexture->atlaspos[gltexture->texid_p - gltexture->glTexExID[0][0]];
+
+  if (pos && *gltexture->texid_p)
+  {
+    int i;
+
+    gltexture->u1 = (float)((pos & 0xffff) - 1) / GL_ATLAS_PAGE_SIZE;
+    gltexture->v1 = (float)(pos >> 16) / GL_ATLAS_PAGE_SIZE;
+    gltexture->scalexfac = (float)gltexture->width / GL_ATLAS_PAGE_SIZE;
+    gltexture->scaleyfac = (float)gltexture->height / GL_ATLAS_PAGE_SIZE;
+
+    for (i = 0; i < GL_ATLAS_PAGES; i++)
+    {
+      if (atlas_pages[i].texid == *gltexture->texid_p)
+      {
+        atlas_pages[i].lastused = atlas_frame;
+        break;
+      }
+    }
+  }
+  else
+  {
+    gltexture->u1 = 0.0f;
+    gltexture->v1 = 0.0f;
+    gltexture->scalexfac = (float)gltexture->width / (float)gltexture->tex_width;
+    gltexture->scaleyfac = (float)gltexture->height / (float)gltexture->tex_height;
+  }
+}
+
+//
+// gld_AtlasRemovePatch
+//
+// Takes a patch off the atlas for good, for callers that need to repeat it.
+//
+
+void gld_AtlasRemovePatch(GLTexture *gltexture)
+{
+  GLuint *first = gltexture->glTexExID[0][0];
+  GLuint *last = first + (CR_LIMIT+MAXPLAYERS) * PLAYERCOLORMAP_COUNT * numcolormaps;
+  int i, j;
+
+  for (i = 0; i < GL_ATLAS_PAGES; i++)
+  {
+    atlas_page_t *page = &atlas_pages[i];
+
+    for (j = 0; j < page->numslots; )
+    {
+      if (page->slots[j] >= first && page->slots[j] < last)
+      {
+        *page->slots[j] = 0;
+        gltexture->atlaspos[page->slots[j] - first] = 0;
+        page->slots[j] = page->slots[--page->numslots];
+      }
+      else
+      {
+        j++;
+      }
+    }
+  }
+
+  gltexture->flags &= ~GLTEXTURE_ATLAS;
+  gltexture->u1 = 0.0f;
+  gltexture->v1 = 0.0f;
+  gltexture->scalexfac = (float)gltexture->width / (float)gltexture->tex_width;
+  gltexture->scaleyfac = (float)gltexture->height / (float)gltexture->tex_height;
+
+  gld_ResetLastTexture();
+}
+
+// Frees all pages; must run before the texture items are cleaned so the
+// page ids held in their slots are not deleted once per patch.
+void gld_AtlasClear(void)
+{
+  int i;
+
+  for (i = 0; i < GL_ATLAS_PAGES; i++)
+  {
+    atlas_page_t *page = &atlas_pages[i];
+
+    gld_AtlasResetPage(page);
+    if (page->texid)
+    {
+      glDeleteTextures(1, &page->texid);
+      page->texid = 0;
+    }
+    page->lastused = 0;
+  }
+}
+
+void gld_AtlasNextFrame(void)
+{
+  atlas_frame++;
+}
+
+#endif
@@ -78,45 +78,20 @@
 
 float frustum[6][4];
 
+// The clipped ranges are kept in one array, sorted by start. Ranges that
+// overlap or touch are always merged, so their ends are sorted as well and
+// both lookups below are binary searches.
 typedef struct clipnode_s
 {
-  struct clipnode_s *prev, *next;
   angle_t start, end;
 } clipnode_t;
 
-clipnode_t *freelist;
-clipnode_t *clipnodes;
-clipnode_t *cliphead;
+static clipnode_t *clipnodes;
+static int numclipnodes;
+static int maxclipnodes;
 
-static clipnode_t * gld_clipnode_GetNew(void);
-static clipnode_t * gld_clipnode_NewRange(angle_t start, angle_t end);
 static dboolean gld_clipper_IsRangeVisible(angle_t startAngle, angle_t endAngle);
 static void gld_clipper_AddClipRange(angle_t start, angle_t end);
-static void gld_clipper_RemoveRange(clipnode_t * range);
-static void gld_clipnode_Free(clipnode_t *node);
-
-static clipnode_t * gld_clipnode_GetNew(void)
-{
-  if (freelist)
-  {
-    clipnode_t * p = freelist;
-    freelist = p->next;
-    return p;
-  }
-  else
-  {
-    return malloc(sizeof(clipnode_t));
-  }
-}
-
-static clipnode_t * gld_clipnode_NewRange(angle_t start, angle_t end)
-{
-  clipnode_t * c = gld_clipnode_GetNew();
-  c->start = start;
-  c->end = end;
-  c->next = c->prev=NULL;
-  return c;
-}
 
 dboolean gld_clipper_SafeCheckRange(angle_t startAngle, angle_t endAngle)
 {
@@ -128,51 +103,52 @@ dboolean gld_clipper_SafeCheckRange(angle_t startAngle, angle_t endAngle)
   return gld_clipper_IsRangeVisible(startAngle, endAngle);
 }
 
-static dboolean gld_clipper_IsRangeVisible(angle_t startAngle, angle_t endAngle)
-{
-  clipnode_t *ci;
-  ci = cliphead;
+// Index of the first range that ends at or after angle.
 
-  if (endAngle == 0 && ci && ci->start == 0)
-    return false;
+static int gld_clipper_FirstEndingAfter(angle_t angle)
+{
+  int lo = 0, hi = numclipnodes;
 
-  while (ci != NULL && ci->start < endAngle)
+  while (lo < hi)
   {
-    if (startAngle >= ci->start && endAngle <= ci->end)
-    {
-      return false;
-    }
-    ci = ci->next;
+    int mid = (lo + hi) >> 1;
+    if (clipnodes[mid].end < angle)
+      lo = mid + 1;
+    else
+      hi = mid;
   }
-
-  return true;
+  return lo;
 }
 
-static void gld_clipnode_Free(clipnode_t *node)
-{
-  node->next = freelist;
-  freelist = node;
-}
+// Index of the first range that starts after angle.
 
-static void gld_clipper_RemoveRange(clipnode_t *range)
+static int gld_clipper_FirstStartingAfter(angle_t angle)
 {
-  if (range == cliphead)
-  {
-    cliphead = cliphead->next;
-  }
-  else
+  int lo = 0, hi = numclipnodes;
+
+  while (lo < hi)
   {
-    if (range->prev)
-    {
-      range->prev->next = range->next;
-    }
-    if (range->next)
-    {
-      range->next->prev = range->prev;
-    }
+    int mid = (lo + hi) >> 1;
+    if (clipnodes[mid].start <= angle)
+      lo = mid + 1;
+    else
+      hi = mid;
   }
+  return lo;
+}
+
+static dboolean gld_clipper_IsRangeVisible(angle_t startAngle, angle_t endAngle)
+{
+  int i;
+
+  if (endAngle == 0 && numclipnodes && clipnodes[0].start == 0)
+    return false;
+
+  // only the last range starting at or before startAngle can contain it;
+  // a range starting exactly at endAngle never hides anything
+  i = gld_clipper_FirstStartingAfter(startAngle) - 1;
 
-  gld_clipnode_Free(range);
+  return !(i >= 0 && clipnodes[i].start < endAngle && endAngle <= clipnodes[i].end);
 }
 
 void gld_clipper_SafeAddClipRange(angle_t startangle, angle_t endangle)
@@ -213,125 +189,39 @@ void gld_clipper_SafeAddClipRangeRealAngles(angle_t startangle, angle_t endangle
 
 static void gld_clipper_AddClipRange(angle_t start, angle_t end)
 {
-  clipnode_t *node, *temp, *prevNode, *node2, *delnode;
+  // ranges [first, last) overlap or touch the new one
+  int first = gld_clipper_FirstEndingAfter(start);
+  int last = gld_clipper_FirstStartingAfter(end);
 
-  if (cliphead)
+  if (first < last)
   {
-    //check to see if range contains any old ranges
-    node = cliphead;
-    while (node != NULL && node->start < end)
-    {
-      if (node->start >= start && node->end <= end)
-      {
-        temp = node;
-        node = node->next;
-        gld_clipper_RemoveRange(temp);
-      }
-      else
-      {
-        if (node->start <= start && node->end >= end)
-        {
-          return;
-        }
-        else
-        {
-          node = node->next;
-        }
-      }
-    }
-
-    //check to see if range overlaps a range (or possibly 2)
-    node = cliphead;
-    while (node != NULL && node->start <= end)
-    {
-      if (node->end >= start)
-      {
-        // we found the first overlapping node
-        if (node->start > start)
-        {
-          // the new range overlaps with this node's start point
-          node->start = start;
-        }
-        if (node->end < end)
-        {
-          node->end = end;
-        }
-
-        node2 = node->next;
-        while (node2 && node2->start <= node->end)
-        {
-          if (node2->end > node->end)
-          {
-            node->end = node2->end;
-          }
-
-          delnode = node2;
-          node2 = node2->next;
-          gld_clipper_RemoveRange(delnode);
-        }
-        return;
-      }
-      node = node->next;
-    }
-
-    //just add range
-    node = cliphead;
-    prevNode = NULL;
-    temp = gld_clipnode_NewRange(start, end);
-    while (node != NULL && node->start < end)
-    {
-      prevNode = node;
-      node = node->next;
-    }
-    temp->next = node;
-    if (node == NULL)
-    {
-      temp->prev = prevNode;
-      if (prevNode)
-      {
-        prevNode->next = temp;
-      }
-      if (!cliphead)
-      {
-        cliphead = temp;
-      }
-    }
-    else
-    {
-      if (node == cliphead)
-      {
-        cliphead->prev = temp;
-        cliphead = temp;
-      }
-      else
-      {
-        temp->prev = prevNode;
-        prevNode->next = temp;
-        node->prev = temp;
-      }
-    }
+    // merge them all into the first
+    if (clipnodes[first].start > start)
+      clipnodes[first].start = start;
+    clipnodes[first].end = MAX(end, clipnodes[last - 1].end);
+
+    memmove(&clipnodes[first + 1], &clipnodes[last],
+            (numclipnodes - last) * sizeof(clipnodes[0]));
+    numclipnodes -= last - first - 1;
+    return;
   }
-  else
+
+  if (numclipnodes == maxclipnodes)
   {
-    temp = gld_clipnode_NewRange(start, end);
-    cliphead = temp;
-    return;
+    maxclipnodes = maxclipnodes ? maxclipnodes * 2 : 128;
+    clipnodes = realloc(clipnodes, maxclipnodes * sizeof(clipnodes[0]));
   }
+
+  memmove(&clipnodes[first + 1], &clipnodes[first],
+          (numclipnodes - first) * sizeof(clipnodes[0]));
+  clipnodes[first].start = start;
+  clipnodes[first].end = end;
+  numclipnodes++;
 }
 
 void gld_clipper_Clear(void)
 {
-  clipnode_t *node = cliphead;
-  clipnode_t *temp;
-
-  while (node != NULL)
-  {
-    temp = node;
-    node = node->next;
-    gld_clipnode_Free(temp);
-  }
-
-  cliphead = NULL;
+  numclipnodes = 0;
 }
 
 angle_t gld_FrustumAngle(void)
@@ -0,0 +1,207 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *   ETC1 / ETC1A4 texture compression and the encoded texture cache.
+ *
+ *   Opaque textures are stored as ETC1 (4 bits per texel), textures with
+ *   transparency as ETC1A4 (ETC1 plus 4 bit alpha, 8 bits per texel)
+ *   instead of 32 bit RGBA. Encoding is slow on the handheld, so results
+ *   are kept in <exedir>/texcache, one file per texture named by the MD5
+ *   of its RGBA data. The encoder lives in gl_etc1enc.c.
+ *
+ *---------------------------------------------------------------------
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gl_opengl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "doomtype.h"
+#include "i_system.h"
+#include "m_io.h"
+#include "md5.h"
+#include "lprintf.h"
+#include "gl_intern.h"
+#include "gl_etc1enc.h"
+
+#ifdef GL_DOOM
+
+int gl_tex_compress;
+
+#ifdef GL_ETC1_ALPHA4_3DS
+
+//
+// Encoded texture cache
+//
+
+#define ETC1_CACHE_MAGIC   "ETC1"
+#define ETC1_CACHE_VERSION 1
+
+static char *etc1_cache_dir;
+
+static const char *gld_ETC1CacheDir(void)
+{
+  if (!etc1_cache_dir)
+  {
+    const char *exedir = I_DoomExeDir();
+    int len = doom_snprintf(NULL, 0, "%s/texcache", exedir);
+
+    etc1_cache_dir = malloc(len + 1);
+    doom_snprintf(etc1_cache_dir, len + 1, "%s/texcache", exedir);
+    M_mkdir(etc1_cache_dir);
+  }
+  return etc1_cache_dir;
+}
+
+static char *gld_ETC1CacheName(const unsigned char *rgba, int width, int height, dboolean use_alpha)
+{
+  struct MD5Context md5;
+  unsigned char digest[16];
+  int header[4] = {ETC1_CACHE_VERSION, width, height, use_alpha};
+  const char *dir = gld_ETC1CacheDir();
+  char *name, *p;
+  int i, len;
+
+  MD5Init(&md5);
+  MD5Update(&md5, (md5byte const *)header, sizeof(header));
+  MD5Update(&md5, rgba, width * height * 4);
+  MD5Final(digest, &md5);
+
+  len = strlen(dir) + 1 + 32 + 4;
+  name = malloc(len + 1);
+  p = name + sprintf(name, "%s/", dir);
+  for (i = 0; i < 16; i++)
+    p += sprintf(p, "%02x", digest[i]);
+  strcpy(p, ".etc");
+
+  return name;
+}
+
+static dboolean gld_ReadETC1Cache(const char *name, unsigned char *out, int size)
+{
+  FILE *f = M_fopen(name, "rb");
+  char magic[4];
+  int fsize;
+  dboolean result;
+
+  if (!f)
+    return false;
+
+  result = fread(magic, 4, 1, f) == 1 && !memcmp(magic, ETC1_CACHE_MAGIC, 4) &&
+    fread(&fsize, sizeof(fsize), 1, f) == 1 && fsize == size &&
+    fread(out, size, 1, f) == 1;
+
+  fclose(f);
+  return result;
+}
+
+static void gld_WriteETC1Cache(const char *name, const unsigned char *data, int size)
+{
+  FILE *f = M_fopen(name, "wb");
+  dboolean ok;
+
+  if (!f)
+    return;
+
+  ok = fwrite(ETC1_CACHE_MAGIC, 4, 1, f) == 1 &&
+    fwrite(&size, sizeof(size), 1, f) == 1 &&
+    fwrite(data, size, 1, f) == 1;
+
+  fclose(f);
+
+  // don't leave a truncated entry behind
+  if (!ok)
+    M_remove(name);
+}
+
+//
+// gld_UploadETC1
+//
+// Uploads a power of two RGBA image to the bound texture in compressed
+// form, picking ETC1A4 if any texel is not opaque.
+//
+
+dboolean gld_UploadETC1(const unsigned char *rgba, int width, int height)
+{
+  const unsigned char *src = rgba;
+  unsigned char *flipped = NULL;
+  unsigned char *data;
+  dboolean use_alpha = false;
+  char *name;
+  int i, size;
+
+  if (width < 8 || height < 8)
+    return false;
+
+  for (i = 0; i < width * height; i++)
+  {
+    if (rgba[i * 4 + 3] != 255)
+    {
+      use_alpha = true;
+      break;
+    }
+  }
+
+#ifdef __3DS__
+  // the PICA200 stores textures bottom-up, the wrapper flips RGBA uploads
+  // itself but compressed blocks have to be encoded that way
+  flipped = malloc(width * height * 4);
+  for (i = 0; i < height; i++)
+    memcpy(flipped + i * width * 4, rgba + (height - 1 - i) * width * 4, width * 4);
+  src = flipped;
+#endif
+
+  size = width * height / (use_alpha ? 1 : 2);
+  data = malloc(size);
+  name = gld_ETC1CacheName(src, width, height, use_alpha);
+
+  if (!gld_ReadETC1Cache(name, data, size))
+  {
+    gld_EncodeETC1(src, width, height, use_alpha, data);
+    gld_WriteETC1Cache(name, data, size);
+  }
+
+  glCompressedTexImage2D(GL_TEXTURE_2D, 0,
+    use_alpha ? GL_ETC1_ALPHA4_3DS : GL_ETC1_RGB8_OES,
+    width, height, 0, size, data);
+
+  free(name);
+  free(data);
+  free(flipped);
+
+  return true;
+}
+#endif
+
+#endif
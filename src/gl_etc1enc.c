@@ -0,0 +1,294 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *   ETC1 block encoder.
+ *
+ *   Has no GL or game dependencies, so tests/test_etc1.c can run it on the
+ *   host; gl_etc1.c does the uploads and the on-disk cache.
+ *
+ *---------------------------------------------------------------------
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <limits.h>
+#include <string.h>
+#include "doomtype.h"
+#include "gl_etc1enc.h"
+
+//
+// ETC1 block encoder
+//
+// A 4x4 block is split into two 2x4 (flip 0) or 4x2 (flip 1) halves, each
+// with a base color and one of eight modifier tables. The base colors are
+// either two 4 bit colors or a 5 bit color plus a 3 bit signed delta.
+// Texels with zero alpha don't count when alpha is stored separately.
+//
+
+static const int etc1_modifiers[8][2] = {
+  {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+};
+
+// pixel index bits -> modifier, see etc1_modifiers
+static const int etc1_index_sign[4] = {1, 1, -1, -1};
+static const int etc1_index_large[4] = {0, 1, 0, 1};
+
+typedef struct
+{
+  unsigned int error;
+  int table;
+  unsigned int indices;  // 2 bits per texel, texel order as in the block
+} etc1_half_t;
+
+static int etc1_clamp(int v)
+{
+  return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+// Picks the table and per texel modifiers for one half with base color
+// base[3]. texels[] holds RGBA of the 8 texels, pos[] their index in the
+// block (x*4+y).
+static void etc1_EncodeHalf(const unsigned char texels[8][4], const int pos[8],
+                            const int base[3], dboolean use_alpha, etc1_half_t *half)
+{
+  int t, i, m;
+
+  half->error = UINT_MAX;
+
+  for (t = 0; t < 8; t++)
+  {
+    unsigned int error = 0, indices = 0;
+
+    for (i = 0; i < 8 && error < half->error; i++)
+    {
+      unsigned int best = UINT_MAX;
+      int best_m = 0;
+
+      if (use_alpha && !texels[i][3])
+        continue;
+
+      for (m = 0; m < 4; m++)
+      {
+        int d = etc1_index_sign[m] * etc1_modifiers[t][etc1_index_large[m]];
+        int dr = etc1_clamp(base[0] + d) - texels[i][0];
+        int dg = etc1_clamp(base[1] + d) - texels[i][1];
+        int db = etc1_clamp(base[2] + d) - texels[i][2];
+        unsigned int e = dr * dr + dg * dg + db * db;
+
+        if (e < best)
+        {
+          best = e;
+          best_m = m;
+        }
+      }
+
+      error += best;
+      indices |= best_m << (pos[i] * 2);
+    }
+
+    if (error < half->error)
+    {
+      half->error = error;
+      half->table = t;
+      half->indices = indices;
+    }
+  }
+}
+
+static void etc1_Average(const unsigned char texels[8][4], dboolean use_alpha, int avg[3])
+{
+  int i, n = 0;
+
+  avg[0] = avg[1] = avg[2] = 0;
+  for (i = 0; i < 8; i++)
+  {
+    if (use_alpha && !texels[i][3])
+      continue;
+    avg[0] += texels[i][0];
+    avg[1] += texels[i][1];
+    avg[2] += texels[i][2];
+    n++;
+  }
+
+  if (n)
+  {
+    avg[0] = (avg[0] + n / 2) / n;
+    avg[1] = (avg[1] + n / 2) / n;
+    avg[2] = (avg[2] + n / 2) / n;
+  }
+}
+
+static void etc1_PutBits(unsigned char *out, unsigned int hi, unsigned int lo)
+{
+  out[0] = hi >> 24; out[1] = hi >> 16; out[2] = hi >> 8; out[3] = hi;
+  out[4] = lo >> 24; out[5] = lo >> 16; out[6] = lo >> 8; out[7] = lo;
+}
+
+// Texel (x,y) of a block is at block[(y * 4 + x) * 4], out gets the 8 byte
+// big endian ETC1 word.
+static void etc1_EncodeBlock(const unsigned char *block, dboolean use_alpha, unsigned char *out)
+{
+  unsigned int best_error = UINT_MAX;
+  unsigned int best_hi = 0, best_lo = 0;
+  int flip;
+
+  for (flip = 0; flip < 2; flip++)
+  {
+    unsigned char texels[2][8][4];
+    int pos[2][8], count[2] = {0, 0};
+    int avg[2][3];
+    int x, y, h, c;
+
+    for (x = 0; x < 4; x++)
+    {
+      for (y = 0; y < 4; y++)
+      {
+        h = (flip ? y : x) >= 2;
+        memcpy(texels[h][count[h]], block + (y * 4 + x) * 4, 4);
+        pos[h][count[h]++] = x * 4 + y;
+      }
+    }
+
+    etc1_Average(texels[0], use_alpha, avg[0]);
+    etc1_Average(texels[1], use_alpha, avg[1]);
+
+    for (c = 0; c < 2; c++)
+    {
+      int q[2][3], base[2][3], delta[3];
+      etc1_half_t half[2];
+      unsigned int hi, indices;
+
+      if (c == 0)
+      {
+        // individual mode, 4 bit base colors
+        for (h = 0; h < 2; h++)
+          for (x = 0; x < 3; x++)
+          {
+            q[h][x] = (avg[h][x] * 15 + 127) / 255;
+            base[h][x] = q[h][x] * 17;
+          }
+      }
+      else
+      {
+        // differential mode, 5 bit base colors close to each other
+        for (h = 0; h < 2; h++)
+          for (x = 0; x < 3; x++)
+          {
+            q[h][x] = (avg[h][x] * 31 + 127) / 255;
+            base[h][x] = (q[h][x] << 3) | (q[h][x] >> 2);
+          }
+        for (x = 0; x < 3; x++)
+        {
+          delta[x] = q[1][x] - q[0][x];
+          if (delta[x] < -4 || delta[x] > 3)
+            break;
+        }
+        if (x < 3)
+          continue;
+      }
+
+      etc1_EncodeHalf(texels[0], pos[0], base[0], use_alpha, &half[0]);
+      etc1_EncodeHalf(texels[1], pos[1], base[1], use_alpha, &half[1]);
+
+      if (half[0].error + half[1].error >= best_error)
+        continue;
+      best_error = half[0].error + half[1].error;
+
+      if (c == 0)
+        hi = (q[0][0] << 28) | (q[1][0] << 24) |
+             (q[0][1] << 20) | (q[1][1] << 16) |
+             (q[0][2] << 12) | (q[1][2] << 8);
+      else
+        hi = (q[0][0] << 27) | ((delta[0] & 7) << 24) |
+             (q[0][1] << 19) | ((delta[1] & 7) << 16) |
+             (q[0][2] << 11) | ((delta[2] & 7) << 8) | 2;
+      hi |= (half[0].table << 5) | (half[1].table << 2) | flip;
+
+      // split the 2 bit indices into the msb and lsb planes
+      indices = half[0].indices | half[1].indices;
+      best_lo = 0;
+      for (x = 0; x < 16; x++)
+      {
+        best_lo |= ((indices >> (x * 2 + 1)) & 1) << (x + 16);
+        best_lo |= ((indices >> (x * 2)) & 1) << x;
+      }
+      best_hi = hi;
+    }
+  }
+
+  etc1_PutBits(out, best_hi, best_lo);
+}
+
+//
+// gld_EncodeETC1
+//
+// Compresses a width x height RGBA image, both multiples of 4. Blocks are
+// written in raster order; with alpha each one is preceded by 8 bytes of
+// 4 bit alpha (little endian, texel x*4+y in bits 4*(x*4+y)), which is the
+// 3DS ETC1A4 layout. Returns the number of bytes written.
+//
+
+int gld_EncodeETC1(const unsigned char *rgba, int width, int height,
+                   dboolean use_alpha, unsigned char *out)
+{
+  unsigned char block[16 * 4];
+  unsigned char *p = out;
+  int bx, by, x, y;
+
+  for (by = 0; by < height; by += 4)
+  {
+    for (bx = 0; bx < width; bx += 4)
+    {
+      for (y = 0; y < 4; y++)
+        memcpy(block + y * 16, rgba + ((by + y) * width + bx) * 4, 16);
+
+      if (use_alpha)
+      {
+        unsigned int alpha[2] = {0, 0};
+
+        for (x = 0; x < 4; x++)
+          for (y = 0; y < 4; y++)
+          {
+            int i = x * 4 + y;
+            alpha[i >> 3] |= (block[(y * 4 + x) * 4 + 3] >> 4) << ((i & 7) * 4);
+          }
+
+        for (x = 0; x < 8; x++)
+          *p++ = alpha[x >> 2] >> ((x & 3) * 8);
+      }
+
+      etc1_EncodeBlock(block, use_alpha, p);
+      p += 8;
+    }
+  }
+
+  return p - out;
+}
@@ -79,6 +79,7 @@ typedef enum
   GLTEXTURE_CLAMPY    = 0x00000080,
   GLTEXTURE_CLAMPXY   = (GLTEXTURE_CLAMPX | GLTEXTURE_CLAMPY),
   GLTEXTURE_MIPMAP    = 0x00000100,
+  GLTEXTURE_ATLAS     = 0x00000200,
 } GLTexture_flag_t;
 
 typedef struct gl_strip_coords_s
@@ -120,6 +121,8 @@ typedef struct
   GLTexType textype;
   unsigned int flags;
   float scalexfac, scaleyfac; //e6y: right/bottom UV coordinates for patch drawing
+  float u1, v1; // left/top UV coordinates of atlas patches
+  int *atlaspos; // page position per glTexExID slot, see gl_atlas.c
 } GLTexture;
 
 typedef struct
@@ -381,6 +384,22 @@ void gld_InitPalettedTextures(void);
 int gld_GetTexDimension(int value);
 void gld_Precache(void);
 
+//gl_atlas
+#define GL_ATLAS_PAGE_SIZE 256
+#define GL_ATLAS_PAGES 4
+#define GL_ATLAS_MAX_ITEM 128 // larger patches keep their own texture
+#define GL_ATLAS_PADDING 1
+extern int gl_texture_atlas;
+dboolean gld_AtlasAddPatch(GLTexture *gltexture, const unsigned char *buffer);
+void gld_AtlasSetCoords(GLTexture *gltexture);
+void gld_AtlasRemovePatch(GLTexture *gltexture);
+void gld_AtlasClear(void);
+void gld_AtlasNextFrame(void);
+
+//gl_etc1
+extern int gl_tex_compress;
+dboolean gld_UploadETC1(const unsigned char *rgba, int width, int height);
+
 void SetFrameTextureMode(void);
 
 //gl_vertex
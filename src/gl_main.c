@@ -518,17 +518,17 @@ void gld_DrawNumPatch_f(float x, float y, int lump, int cm, enum patch_translati
 
   if (!gltexture)
     return;
-  fV1=0.0f;
-  fV2=gltexture->scaleyfac;
+  fV1=gltexture->v1;
+  fV2=gltexture->v1+gltexture->scaleyfac;
   if (flags & VPT_FLIP)
   {
-    fU1=gltexture->scalexfac;
-    fU2=0.0f;
+    fU1=gltexture->u1+gltexture->scalexfac;
+    fU2=gltexture->u1;
   }
   else
   {
-    fU1=0.0f;
-    fU2=gltexture->scalexfac;
+    fU1=gltexture->u1;
+    fU2=gltexture->u1+gltexture->scalexfac;
   }
 
   if (flags & VPT_NOOFFSET)
@@ -649,6 +649,11 @@ void gld_FillPatch(int lump, int x, int y, int width, int height, enum patch_tra
   boom_cm = 0;
 
   gltexture = gld_RegisterPatch(lump, CR_DEFAULT, false);
+
+  // the fill repeats the patch, which an atlas page can't do
+  if (gltexture && (gltexture->flags & GLTEXTURE_ATLAS))
+    gld_AtlasRemovePatch(gltexture);
+
   gld_BindPatch(gltexture, CR_DEFAULT);
 
   if (!gltexture)
@@ -745,10 +750,10 @@ void gld_DrawWeapon(int weaponlump, vissprite_t *vis, int lightlevel)
   if (!gltexture)
     return;
   gld_BindPatch(gltexture, CR_DEFAULT);
-  fU1=0;
-  fV1=0;
-  fU2=gltexture->scalexfac;
-  fV2=gltexture->scaleyfac;
+  fU1=gltexture->u1;
+  fV1=gltexture->v1;
+  fU2=gltexture->u1+gltexture->scalexfac;
+  fV2=gltexture->v1+gltexture->scaleyfac;
   // e6y
   // More precise weapon drawing:
   // Shotgun from DSV3_War looks correctly now. Especially during movement.
@@ -894,6 +899,8 @@ void gld_Finish(void)
   }
 
   I_SwapBuffers();
+
+  gld_AtlasNextFrame();
 }
 
 GLuint flats_vbo_id = 0; // ID of VBO
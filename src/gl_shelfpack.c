@@ -0,0 +1,98 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *   Shelf packer for the texture atlas pages. It does not touch GL, so
+ *   tests/test_atlas.c runs it on the host.
+ *
+ *---------------------------------------------------------------------
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "z_zone.h"
+#include "doomtype.h"
+#include "gl_shelfpack.h"
+
+//
+// gld_ShelfPack
+//
+// Puts a width x height item on a size x size page, on the shelf that
+// wastes the least height, or opens a new shelf under the last one.
+// Returns false and leaves the page alone if it has no room left.
+//
+
+dboolean gld_ShelfPack(shelfpack_t *pack, int size, int width, int height, int *x, int *y)
+{
+  shelfpack_shelf_t *best = NULL;
+  int i;
+
+  for (i = 0; i < pack->numshelves; i++)
+  {
+    shelfpack_shelf_t *shelf = &pack->shelves[i];
+
+    if (shelf->height >= height && shelf->x + width <= size &&
+        (!best || shelf->height < best->height))
+      best = shelf;
+  }
+
+  // don't waste a tall shelf on a short item if a new one still fits
+  if (best && best->height > height * 2 && pack->bottom + height <= size)
+    best = NULL;
+
+  if (!best)
+  {
+    if (width > size || pack->bottom + height > size)
+      return false;
+
+    if (pack->numshelves == pack->maxshelves)
+    {
+      pack->maxshelves = pack->maxshelves ? pack->maxshelves * 2 : 16;
+      pack->shelves = realloc(pack->shelves, pack->maxshelves * sizeof(pack->shelves[0]));
+    }
+    best = &pack->shelves[pack->numshelves++];
+    best->y = pack->bottom;
+    best->height = height;
+    best->x = 0;
+    pack->bottom += height;
+  }
+
+  *x = best->x;
+  *y = best->y;
+  best->x += width;
+
+  return true;
+}
+
+void gld_ShelfPackReset(shelfpack_t *pack)
+{
+  pack->numshelves = 0;
+  pack->bottom = 0;
+}
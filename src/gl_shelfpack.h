@@ -0,0 +1,56 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *   Shelf packer for the texture atlas pages.
+ *
+ *---------------------------------------------------------------------
+ */
+
+#ifndef _GL_SHELFPACK_H
+#define _GL_SHELFPACK_H
+
+#include "doomtype.h"
+
+typedef struct
+{
+  int y, height;        // shelf band on the page
+  int x;                // first free column
+} shelfpack_shelf_t;
+
+typedef struct
+{
+  shelfpack_shelf_t *shelves;
+  int numshelves, maxshelves;
+  int bottom;           // first row below the last shelf
+} shelfpack_t;
+
+dboolean gld_ShelfPack(shelfpack_t *pack, int size, int width, int height, int *x, int *y);
+void gld_ShelfPackReset(shelfpack_t *pack);
+
+#endif
@@ -740,7 +740,8 @@ int gld_BuildTexture(GLTexture *gltexture, void *data, dboolean readonly, int wi
   {
     if (width == tex_width)
     {
-      tex_buffer = malloc(tex_buffer_size);
+      // clear the padding rows, gld_UploadETC1 hashes the whole buffer
+      tex_buffer = calloc(1, tex_buffer_size);
       memcpy(tex_buffer, data, width * height * 4);
     }
     else
@@ -759,6 +760,9 @@ int gld_BuildTexture(GLTexture *gltexture, void *data, dboolean readonly, int wi
     tex_buffer = data;
   }
 
+#ifdef GL_ETC1_ALPHA4_3DS
+  if (!gl_tex_compress || !gld_UploadETC1(tex_buffer, tex_width, tex_height))
+#endif
   glTexImage2D( GL_TEXTURE_2D, 0, gl_tex_format,
     tex_width, tex_height,
     0, GL_RGBA, GL_UNSIGNED_BYTE, tex_buffer);
@@ -890,6 +894,21 @@ GLTexture *gld_RegisterPatch(int lump, int cm, dboolean is_sprite)
     gltexture->scalexfac=(float)gltexture->width/(float)gltexture->tex_width;
     gltexture->scaleyfac=(float)gltexture->height/(float)gltexture->tex_height;
 
+    // small 2D patches are packed onto shared atlas pages unpadded,
+    // gld_BuildTexture pads them if they end up with their own texture
+    if (gl_texture_atlas && !(gltexture->flags & (GLTEXTURE_SPRITE | GLTEXTURE_MIPMAP)) &&
+        gltexture->realtexwidth <= GL_ATLAS_MAX_ITEM &&
+        gltexture->realtexheight <= GL_ATLAS_MAX_ITEM)
+    {
+      int dims = (CR_LIMIT+MAXPLAYERS) * PLAYERCOLORMAP_COUNT * numcolormaps;
+
+      gltexture->flags |= GLTEXTURE_ATLAS;
+      gltexture->buffer_width=gltexture->realtexwidth;
+      gltexture->buffer_height=gltexture->realtexheight;
+      if (!gltexture->atlaspos)
+        gltexture->atlaspos=calloc(dims, sizeof(gltexture->atlaspos[0]));
+    }
+
     gltexture->buffer_size=gltexture->buffer_width*gltexture->buffer_height*4;
     R_UnlockPatchNum(lump);
     if (gltexture->realtexwidth>gltexture->buffer_width)
@@ -901,6 +920,57 @@ GLTexture *gld_RegisterPatch(int lump, int cm, dboolean is_sprite)
   return gltexture;
 }
 
+// Binds a patch that lives on an atlas page. Patches sharing the page
+// don't rebind it, the UV origin of the current slot is kept in u1/v1.
+static void gld_BindAtlasPatch(GLTexture *gltexture, int cm)
+{
+  const rpatch_t *patch;
+  unsigned char *buffer;
+
+  if (last_glTexID == gltexture->texid_p)
+  {
+    gld_AtlasSetCoords(gltexture);
+    return;
+  }
+
+  if (*gltexture->texid_p != 0)
+  {
+    if (!last_glTexID || *last_glTexID != *gltexture->texid_p)
+      glBindTexture(GL_TEXTURE_2D, *gltexture->texid_p);
+    last_glTexID = gltexture->texid_p;
+    gld_AtlasSetCoords(gltexture);
+    return;
+  }
+
+  patch=R_CachePatchNum(gltexture->index);
+  buffer=(unsigned char*)Z_Malloc(gltexture->buffer_size,PU_STATIC,0);
+  memset(buffer,0,gltexture->buffer_size);
+  gld_AddPatchToTexture(gltexture, buffer, patch, 0, 0, cm, false);
+
+  if ((gltexture->flags & GLTEXTURE_HASHOLES))
+  {
+    SmoothEdges(buffer, gltexture->buffer_width, gltexture->buffer_height);
+  }
+
+  if (gld_AtlasAddPatch(gltexture, buffer))
+  {
+    Z_Free(buffer);
+  }
+  else
+  {
+    // no room on the atlas this frame, fall back to a texture of its own
+    glGenTextures(1, gltexture->texid_p);
+    glBindTexture(GL_TEXTURE_2D, *gltexture->texid_p);
+    gld_BuildTexture(gltexture, buffer, false, gltexture->buffer_width, gltexture->buffer_height);
+    gld_SetTexClamp(gltexture, GLTEXTURE_CLAMPXY);
+  }
+
+  last_glTexID = gltexture->texid_p;
+  gld_AtlasSetCoords(gltexture);
+
+  R_UnlockPatchNum(gltexture->index);
+}
+
 void gld_BindPatch(GLTexture *gltexture, int cm)
 {
   const rpatch_t *patch;
@@ -915,6 +985,12 @@ void gld_BindPatch(GLTexture *gltexture, int cm)
 
   gld_GetTextureTexID(gltexture, cm);
 
+  if (gltexture->flags & GLTEXTURE_ATLAS)
+  {
+    gld_BindAtlasPatch(gltexture, cm);
+    return;
+  }
+
   if (last_glTexID == gltexture->texid_p)
   {
     gld_SetTexClamp(gltexture, GLTEXTURE_CLAMPXY);
@@ -1068,6 +1144,9 @@ static void gld_CleanTexItems(int count, GLTexture ***items)
   if (!(*items))
     return;
 
+  // the atlas pages are shared by many items
+  gld_AtlasClear();
+
   for (i=0; i<count; i++)
   {
     if ((*items)[i])
@@ -1090,6 +1169,9 @@ static void gld_CleanTexItems(int count, GLTexture ***items)
       Z_Free((*items)[i]->glTexExID);
       (*items)[i]->glTexExID = NULL;
 
+      free((*items)[i]->atlaspos);
+      (*items)[i]->atlaspos = NULL;
+
       Z_Free((*items)[i]);
     }
   }
@@ -85,7 +85,7 @@
 
 typedef struct vertexsplit_info_s
 {
-  dboolean changed;
+  unsigned int version; // sum of the versions of its sectors when computed
   int numheights;
   int numsectors;
   sector_t **sectors;
@@ -95,12 +95,10 @@ typedef struct vertexsplit_info_s
 
 static vertexsplit_info_t * gl_vertexsplit = NULL;
 
-typedef struct splitsbysector_s
-{
-  int numsplits;
-  vertexsplit_info_t **splits;
-} splitsbysector_t;
-static splitsbysector_t * gl_splitsbysector = NULL;
+// Bumped whenever a sector's planes move. A vertex only rebuilds its
+// height list when it is drawn and the sum of its sectors' versions has
+// changed, so any number of moves in a frame cost one rebuild.
+static unsigned int * gl_sectorversion = NULL;
 
 //==========================================================================
 //
@@ -204,10 +202,20 @@ void gld_RecalcVertexHeights(const vertex_t *v)
 
   vi->validcount = rendermarker;
 
-  if (!vi->changed)
+  if (!vi->numsectors)
     return;
 
-  vi->changed = false;
+  {
+    unsigned int version = 0;
+
+    for(i = 0; i < vi->numsectors; i++)
+      version += gl_sectorversion[vi->sectors[i]->iSectorID];
+
+    if (version == vi->version)
+      return;
+
+    vi->version = version;
+  }
 
   vi->numheights = 0;
   for(i = 0; i < vi->numsectors; i++)
@@ -261,26 +269,6 @@ static void AddToVertex(const sector_t *sec, int **list, unsigned int *size)
   (*size)++;
 }
 
-//==========================================================================
-//
-// 
-//
-//==========================================================================
-static void AddToSplitBySector(vertexsplit_info_t *vi, splitsbysector_t *splitsbysector)
-{
-  int i;
-  for(i = 0; i < splitsbysector->numsplits; i++)
-  {
-    if (splitsbysector->splits[i] == vi)
-      return;
-  }
-  splitsbysector->splits = realloc(
-    splitsbysector->splits, 
-    sizeof(splitsbysector->splits) * (splitsbysector->numsplits + 1));
-  splitsbysector->splits[splitsbysector->numsplits] = vi;
-  splitsbysector->numsplits++;
-}
-
 //==========================================================================
 //
 // 
@@ -350,7 +338,7 @@ void gld_InitVertexData()
     vi->numheights = 0;
     if (cnt > 1)
     {
-      vi->changed = true;
+      vi->version = (unsigned int)-1; // never the sum of fresh versions
       vi->numsectors = cnt;
 
       vi->sectors = (sector_t **)((unsigned char*)gl_vertexsplit + pos);
@@ -369,22 +357,7 @@ void gld_InitVertexData()
     }
   }
 
-  gl_splitsbysector = malloc(sizeof(gl_splitsbysector[0]) * numsectors);
-  memset(gl_splitsbysector, 0, sizeof(gl_splitsbysector[0]) * numsectors);
-
-  for(i = 0; i < numsectors; i++)
-  {
-    for(j = 0; j < numvertexes; j++)
-    {
-      vertexsplit_info_t *vi = &gl_vertexsplit[j];
-
-      for(k = 0; k < vi->numsectors; k++)
-      {
-        if (vi->sectors[k] == &sectors[i])
-          AddToSplitBySector(vi, &gl_splitsbysector[i]);
-      }
-    }
-  }
+  gl_sectorversion = calloc(numsectors, sizeof(gl_sectorversion[0]));
 
   for(i = 0; i < numvertexes; i++)
     gld_RecalcVertexHeights(&vertexes[i]);
@@ -400,15 +373,9 @@ void gld_InitVertexData()
 //==========================================================================
 void gld_UpdateSplitData(sector_t *sector)
 {
-  int i;
-
-  if (gl_splitsbysector)
+  if (gl_sectorversion)
   {
-    splitsbysector_t *splitsbysector = &gl_splitsbysector[sector->iSectorID];
-    for (i = 0; i < splitsbysector->numsplits; i++)
-    {
-      splitsbysector->splits[i]->changed = true;
-    }
+    gl_sectorversion[sector->iSectorID]++;
   }
 }
 
@@ -425,18 +392,10 @@ void gld_CleanVertexData()
     gl_vertexsplit = NULL;
   }
 
-  if (gl_splitsbysector)
+  if (gl_sectorversion)
   {
-    int i;
-    for(i = 0; i < numsectors; i++)
-    {
-      if (gl_splitsbysector[i].numsplits > 0)
-      {
-        free(gl_splitsbysector[i].splits);
-      }
-    }
-    free(gl_splitsbysector);
-    gl_splitsbysector = NULL;
+    free(gl_sectorversion);
+    gl_sectorversion = NULL;
   }
 }
 
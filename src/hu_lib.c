@@ -267,7 +267,7 @@ void HUlib_eraseTextLine(hu_textline_t* l)
         // erase left border
         R_VideoErase(0, y, viewwindowx);
         // erase right border
-        R_VideoErase(viewwindowx + viewwidth, y, viewwindowx);
+        R_VideoErase(viewwindowx + scaledviewwidth, y, viewwindowx);
       }
     }
   }
@@ -620,7 +620,7 @@ static void HUlib_eraseMBg(hu_mtext_t* m)
         // erase left border
         R_VideoErase(0, y, viewwindowx);
         // erase right border
-        R_VideoErase(viewwindowx + viewwidth, y, viewwindowx);
+        R_VideoErase(viewwindowx + scaledviewwidth, y, viewwindowx);
 
       }
     }
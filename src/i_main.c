@@ -63,6 +63,7 @@
 #include <3ds.h>
 #else
 #include <SDL/SDL_timer.h>
+#include <sys/time.h>
 #endif
 
 #include "e6y.h"
@@ -90,6 +91,19 @@ int I_GetTime_MS(void)
   return ticks - basetime;
 }
 
+// Microsecond clock for the frame pacer, see R_PaceFrame
+uint_64_t I_GetTime_US(void)
+{
+#ifdef __3DS__
+  return (uint_64_t)(svcGetSystemTick() * 1000.0 / CPU_TICKS_PER_MSEC);
+#else
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (uint_64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
 int ms_to_next_tick;
 
 int I_GetTime_RealTime (void)
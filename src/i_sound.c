@@ -737,6 +737,7 @@ void I_ResampleStream (void *dest, unsigned nsamp, void (*proc) (void *dest, uns
 //
 
 #include "mus2mid.h"
+#include "md5.h"
 
 
 static Mix_Music *music[2] = { NULL, NULL };
@@ -751,6 +752,8 @@ static char *music_tmp = NULL; /* cph - name of music temporary file */
 static const char *music_tmp_ext[] = { "", ".mp3", ".ogg" };
 #define MUSIC_TMP_EXT (sizeof(music_tmp_ext)/sizeof(*music_tmp_ext))
 
+static void I_FreeMusicCache(void);
+
 void I_ShutdownMusic(void)
 {
   if (music_tmp) {
@@ -769,6 +772,7 @@ void I_ShutdownMusic(void)
     free(music_tmp);
     music_tmp = NULL;
   }
+  I_FreeMusicCache();
 }
 
 void I_InitMusic(void)
@@ -859,11 +863,175 @@ void I_UnRegisterSong(int handle)
   }
 }
 
+// Music lump formats told apart by their signature, so a lump is only
+// handed to the loader that can take it.
+typedef enum
+{
+  music_unknown,
+  music_mus,
+  music_midi,
+  music_ogg,
+  music_mp3,
+} music_format_t;
+
+static music_format_t I_SniffMusic(const byte *data, size_t len)
+{
+  if (len < 4)
+    return music_unknown;
+  if (!memcmp(data, "MUS", 3))
+    return music_mus;
+  if (!memcmp(data, "MThd", 4))
+    return music_midi;
+  if (!memcmp(data, "OggS", 4))
+    return music_ogg;
+  if (!memcmp(data, "ID3", 3) || (data[0] == 0xff && (data[1] & 0xe0) == 0xe0))
+    return music_mp3;
+  return music_unknown;
+}
+
+// Converted MUS lumps, keyed by the MD5 of the lump and kept for the
+// session, so a song that comes back is not converted again. The oldest
+// entries go once the cache holds more than MUSIC_CACHE_SIZE bytes.
+#define MUSIC_CACHE_SIZE (2*1024*1024)
+
+typedef struct music_cache_s
+{
+  struct music_cache_s *next;
+  byte digest[16];
+  void *midi;
+  size_t len;
+} music_cache_t;
+
+static music_cache_t *music_cache;    // most recently used first
+
+static void I_FreeMusicCache(void)
+{
+  while (music_cache)
+  {
+    music_cache_t *next = music_cache->next;
+
+    free(music_cache->midi);
+    free(music_cache);
+    music_cache = next;
+  }
+}
+
+// e6y: from Chocolate-Doom
+// Converts a MUS lump to MIDI, returns false on failure.
+static dboolean I_ConvertMus(const void *data, size_t len, void **midi, size_t *midi_len)
+{
+  MEMFILE *instream;
+  MEMFILE *outstream;
+  void *outbuf;
+  int result;
+
+  instream = mem_fopen_read(data, len);
+  outstream = mem_fopen_write();
+
+  // e6y: from chocolate-doom
+  // New mus -> mid conversion code thanks to Ben Ryves <benryves@benryves.com>
+  // This plays back a lot of music closer to Vanilla Doom - eg. tnt.wad map02
+  result = mus2mid(instream, outstream);
+
+  if (result != 0)
+  {
+    size_t muslen = len;
+    const unsigned char *musptr = (const unsigned char* )data;
+
+    // haleyjd 04/04/10: scan forward for a MUS header. Evidently DMX was 
+    // capable of doing this, and would skip over any intervening data. That, 
+    // or DMX doesn't use the MUS header at all somehow.
+    while (musptr < (const unsigned char*)data + len - sizeof(musheader))
+    {
+      // if we found a likely header start, reset the mus pointer to that location,
+      // otherwise just leave it alone and pray.
+      if (!strncmp((const char*)musptr, "MUS\x1a", 4))
+      {
+        mem_fclose(instream);
+        instream = mem_fopen_read(musptr, muslen);
+        result = mus2mid(instream, outstream);
+        break;
+      }
+
+      musptr++;
+      muslen--;
+    }
+  }
+
+  if (result == 0)
+  {
+    mem_get_buf(outstream, &outbuf, midi_len);
+    *midi = malloc(*midi_len);
+    memcpy(*midi, outbuf, *midi_len);
+  }
+
+  mem_fclose(instream);
+  mem_fclose(outstream);
+
+  return result == 0;
+}
+
+// Returns the MIDI for a MUS lump from the cache, converting it on a miss.
+static music_cache_t *I_GetMusAsMidi(const void *data, size_t len)
+{
+  struct MD5Context md5;
+  byte digest[16];
+  music_cache_t *entry, **prev;
+  size_t total = 0;
+
+  MD5Init(&md5);
+  MD5Update(&md5, (md5byte const *)data, len);
+  MD5Final(digest, &md5);
+
+  for (prev = &music_cache; (entry = *prev); prev = &entry->next)
+  {
+    if (!memcmp(entry->digest, digest, sizeof(digest)))
+    {
+      // move to the front
+      *prev = entry->next;
+      entry->next = music_cache;
+      music_cache = entry;
+      return entry;
+    }
+  }
+
+  entry = calloc(1, sizeof(*entry));
+  if (!I_ConvertMus(data, len, &entry->midi, &entry->len))
+  {
+    free(entry);
+    return NULL;
+  }
+  memcpy(entry->digest, digest, sizeof(digest));
+  entry->next = music_cache;
+  music_cache = entry;
+
+  // drop the oldest songs, but never the one just added
+  for (prev = &music_cache; *prev; )
+  {
+    total += (*prev)->len;
+    if (*prev != entry && total > MUSIC_CACHE_SIZE)
+    {
+      music_cache_t *old = *prev;
+
+      *prev = old->next;
+      free(old->midi);
+      free(old);
+    }
+    else
+    {
+      prev = &(*prev)->next;
+    }
+  }
+
+  return entry;
+}
+
 int I_RegisterSong(const void *data, size_t len)
 {
   int i;
   char *name;
   dboolean io_errors = false;
+  music_format_t format = I_SniffMusic(data, len);
 
   if (music_tmp == NULL)
     return 0;
@@ -875,90 +1043,47 @@ int I_RegisterSong(const void *data, size_t len)
 
   music[0] = NULL;
 
-  if (len > 4 && memcmp(data, "MUS", 3) != 0)
+  if (len > 4 && format != music_mus)
   {
     // The header has no MUS signature
-    // Let's try to load this song with SDL
-    for (i = 0; i < MUSIC_TMP_EXT; i++)
+    // Let's try to load this song with SDL, straight from memory first
+    rw_midi = SDL_RWFromConstMem(data, len);
+    if (rw_midi)
     {
-      // Current SDL_mixer (up to 1.2.8) cannot load some MP3 and OGG
-      // without proper extension
+      music[0] = Mix_LoadMUS_RW(rw_midi);
+    }
+
+    // Current SDL_mixer (up to 1.2.8) cannot load some MP3 and OGG
+    // without proper extension, so fall back to a temporary file, named
+    // for the detected format where there is one
+    for (i = 0; i < MUSIC_TMP_EXT && !music[0]; i++)
+    {
+      if ((format == music_mp3 && strcmp(music_tmp_ext[i], ".mp3")) ||
+          (format == music_ogg && strcmp(music_tmp_ext[i], ".ogg")) ||
+          (format == music_midi && i > 0))
+        continue;
+
       name = (char*)malloc(strlen(music_tmp) + strlen(music_tmp_ext[i]) + 1);
       sprintf(name, "%s%s", music_tmp, music_tmp_ext[i]);
 
-      if (strlen(music_tmp_ext[i]) == 0)
-      {
-        //midi
-        rw_midi = SDL_RWFromConstMem(data, len);
-        if (rw_midi)
-        {
-          music[0] = Mix_LoadMUS_RW(rw_midi);
-        }
-      }
-
-      if (!music[0])
+      io_errors = (M_WriteFile(name, data, len) == 0);
+      if (!io_errors)
       {
-        io_errors = (M_WriteFile(name, data, len) == 0);
-        if (!io_errors)
-        {
-          music[0] = Mix_LoadMUS(name);
-        }
+        music[0] = Mix_LoadMUS(name);
       }
 
       free(name);
-      if (music[0])
-        break; // successfully loaded
     }
   }
 
-  // e6y: from Chocolate-Doom
   // Assume a MUS file and try to convert
   if (len > 4 && !music[0])
   {
-    MEMFILE *instream;
-    MEMFILE *outstream;
-    void *outbuf;
-    size_t outbuf_len;
-    int result;
-
-    instream = mem_fopen_read(data, len);
-    outstream = mem_fopen_write();
+    music_cache_t *midi = I_GetMusAsMidi(data, len);
 
-    // e6y: from chocolate-doom
-    // New mus -> mid conversion code thanks to Ben Ryves <benryves@benryves.com>
-    // This plays back a lot of music closer to Vanilla Doom - eg. tnt.wad map02
-    result = mus2mid(instream, outstream);
-
-    if (result != 0)
+    if (midi)
     {
-      size_t muslen = len;
-      const unsigned char *musptr = (const unsigned char* )data;
-
-      // haleyjd 04/04/10: scan forward for a MUS header. Evidently DMX was 
-      // capable of doing this, and would skip over any intervening data. That, 
-      // or DMX doesn't use the MUS header at all somehow.
-      while (musptr < (const unsigned char*)data + len - sizeof(musheader))
-      {
-        // if we found a likely header start, reset the mus pointer to that location,
-        // otherwise just leave it alone and pray.
-        if (!strncmp((const char*)musptr, "MUS\x1a", 4))
-        {
-          mem_fclose(instream);
-          instream = mem_fopen_read(musptr, muslen);
-          result = mus2mid(instream, outstream);
-          break;
-        }
-
-        musptr++;
-        muslen--;
-      }
-    }
-
-    if (result == 0)
-    {
-      mem_get_buf(outstream, &outbuf, &outbuf_len);
-      
-      rw_midi = SDL_RWFromMem(outbuf, outbuf_len);
+      rw_midi = SDL_RWFromMem(midi->midi, midi->len);
       if (rw_midi)
       {
         music[0] = Mix_LoadMUS_RW(rw_midi);
@@ -966,7 +1091,7 @@ int I_RegisterSong(const void *data, size_t len)
       
       if (!music[0])
       {
-        io_errors = M_WriteFile(music_tmp, outbuf, outbuf_len) == 0;
+        io_errors = M_WriteFile(music_tmp, midi->midi, midi->len) == 0;
 
         if (!io_errors)
         {
@@ -975,9 +1100,6 @@ int I_RegisterSong(const void *data, size_t len)
         }
       }
     }
-
-    mem_fclose(instream);
-    mem_fclose(outstream);
   }
   
   // Failed to load
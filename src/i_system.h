@@ -44,6 +44,7 @@ extern int ms_to_next_tick;
 dboolean I_StartDisplay(void);
 void I_EndDisplay(void);
 int I_GetTime_MS(void);
+uint_64_t I_GetTime_US(void);
 int I_GetTime_RealTime(void);     /* killough */
 #ifndef PRBOOM_SERVER
 fixed_t I_GetTimeFrac (void);
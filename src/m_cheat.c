@@ -73,6 +73,7 @@ static void cheat_clev();
 static void cheat_clev0();
 static void cheat_mypos();
 static void cheat_rate();
+static void cheat_cache();
 static void cheat_comp();
 static void cheat_friction();
 static void cheat_pushers();
@@ -140,6 +141,7 @@ cheatseq_t cheat[] = {
   CHEAT("idclev",     "Level Warp",       cht_never | not_menu, cheat_clev0, 0),
   CHEAT("idmypos",    "Player Position",  not_dm, cheat_mypos, 0),
   CHEAT("idrate",     "Frame rate",       always, cheat_rate, 0),
+  CHEAT("idcache",    "Cache stats",      always, cheat_cache, 0),
   // phares
   CHEAT("tntcomp",    NULL,               cht_never, cheat_comp, 0),
   // jff 2/01/98 kill all monsters
@@ -470,6 +472,12 @@ static void cheat_rate()
   rendering_stats ^= 1;
 }
 
+// toggle purgable lump/patch cache statistics display
+static void cheat_cache()
+{
+  cache_stats ^= 1;
+}
+
 // compatibility cheat
 
 static void cheat_comp()
@@ -3257,6 +3257,7 @@ setup_menu_t gen_settings1[] = { // General Settings screen1
   {"Enable Translucency",            S_YESNO,            m_null, G_X, G_Y+ 6*8, {"translucency"}, 0, 0, M_Trans},
   {"Translucency filter percentage", S_NUM,              m_null, G_X, G_Y+ 7*8, {"tran_filter_pct"}, 0, 0, M_Trans},
   {"Uncapped Framerate",             S_YESNO,            m_null, G_X, G_Y+ 8*8, {"uncapped_framerate"}, 0, 0, M_ChangeUncappedFrameRate},
+  {"Framerate Limit (0 = none)",     S_NUM,              m_null, G_X, G_Y+ 9*8, {"uncapped_fps_limit"}},
 
   {"Sound & Music",                  S_SKIP|S_TITLE,     m_null, G_X, G_Y+10*8},
   {"Number of Sound Channels",       S_NUM|S_PRGWARN,    m_null, G_X, G_Y+11*8, {"snd_channels"}},
@@ -67,6 +67,7 @@
 #include "lprintf.h"
 #include "d_main.h"
 #include "d_deh.h"
+#include "p_setup.h"
 #include "r_draw.h"
 #include "r_demo.h"
 #include "r_fps.h"
@@ -160,6 +161,8 @@ extern int gl_sprite_filter;
 extern int gl_patch_filter;
 extern const char *gl_tex_format_string;
 extern int gl_sky_detail;
+extern int gl_texture_atlas;
+extern int gl_tex_compress;
 
 //e6y: fog
 extern int gl_fog;
@@ -175,6 +178,8 @@ static int gl_sprite_filter;
 static int gl_patch_filter;
 static const char *gl_tex_format_string;
 static int gl_sky_detail;
+static int gl_texture_atlas;
+static int gl_tex_compress;
 static int gl_fog;
 static int gl_fog_color;
 static int gl_finish;
@@ -244,6 +249,8 @@ default_t defaults[] =
    def_int,ss_none}, // 1=take special steps ensuring demo sync, 2=only during recordings
   {"level_precache",{(int*)&precache},{1},0,1,
    def_bool,ss_none}, // precache level data?
+  {"level_preload",{&level_preload},{1},0,1,
+   def_bool,ss_none}, // read the next level during the intermission?
   {"demo_smoothturns", {&demo_smoothturns},  {0},0,1,
    def_bool,ss_stat},
   {"demo_smoothturnsfactor", {&demo_smoothturnsfactor},  {6},1,SMOOTH_PLAYING_MAXFACTOR,
@@ -377,6 +384,8 @@ default_t defaults[] =
    def_int,ss_none}, // gamma correction level // killough 1/18/98
   {"uncapped_framerate", {&movement_smooth_default},  {1},0,1,
    def_bool,ss_stat},
+  {"uncapped_fps_limit", {&uncapped_fps_limit},  {0},0,1000,
+   def_int,ss_stat}, // frames per second when uncapped, 0 = no limit
   {"filter_wall",{(int*)&drawvars.filterwall},{RDRAW_FILTER_POINT},
    RDRAW_FILTER_POINT, RDRAW_FILTER_ROUNDED, def_int,ss_none},
   {"filter_floor",{(int*)&drawvars.filterfloor},{RDRAW_FILTER_POINT},
@@ -409,6 +418,10 @@ default_t defaults[] =
    {filter_nearest}, filter_nearest, filter_linear, def_int,ss_none},
   {"gl_tex_format_string", {NULL,&gl_tex_format_string}, {0,"GL_RGBA"},UL,UL,
    def_str,ss_none},
+  {"gl_texture_atlas",{&gl_texture_atlas},{1},0,1,
+   def_bool,ss_none}, // pack HUD patches and fonts onto shared textures
+  {"gl_tex_compress",{&gl_tex_compress},{0},0,1,
+   def_bool,ss_none}, // ETC1 compress textures where supported, see gl_etc1.c
   {"gl_sprite_offset",{&gl_sprite_offset_default},{0}, 0, 5,
    def_int,ss_none}, // amount to bring items out of floor (GL) Mead 8/13/03
   {"gl_sprite_blend",{&gl_sprite_blend},{0},0,1,
@@ -902,6 +915,8 @@ default_t defaults[] =
    def_int,ss_stat},
 
   {"Prboom-plus misc settings",{NULL},{0},UL,UL,def_none,ss_none},
+  {"cache_memory_budget", {&cache_memory_budget}, {0},0,UL,
+   def_int,ss_none}, // purgable lump/patch cache limit in kilobytes, 0 = unlimited
   {"showendoom", {&showendoom},  {1},0,1,
    def_bool,ss_stat},
   {"health_bar", {&health_bar}, {0},0,1,
@@ -938,6 +953,14 @@ default_t defaults[] =
   def_int,ss_stat},
   {"render_stretchsky",{&r_stretchsky},{1},0,1,
    def_bool,ss_none},
+  {"render_dynres",{&render_dynres},{0},0,1,
+   def_bool,ss_none}, // lower the software render width when frames are slow
+  {"render_dynres_min",{&render_dynres_min},{50},25,100,
+   def_int,ss_none}, // lowest render width, percent of the view window
+  {"render_dynres_target",{&render_dynres_target},{16},1,100,
+   def_int,ss_none}, // ms per rendered view to aim for
+  {"render_dirtyrects",{&render_dirtyrects},{1},0,1,
+   def_bool,ss_none}, // present only the parts of the screen that changed
   {"sprites_doom_order", {&sprites_doom_order}, {DOOM_ORDER_STATIC},0,DOOM_ORDER_LAST - 1,
    def_int,ss_stat},
 
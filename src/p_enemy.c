@@ -364,6 +364,7 @@ static dboolean P_Move(mobj_t *actor, dboolean dropoff) /* killough 9/12/98 */
       //         restores floorz, ceilingz and dropoffz values as well
       actor->x = origx;
       actor->y = origy;
+      P_SyncBlockThing(actor);
       movefactor *= FRACUNIT / ORIG_FRICTION_FACTOR / 4;
       actor->momx += FixedMul(deltax, movefactor);
       actor->momy += FixedMul(deltay, movefactor);
@@ -1488,6 +1489,7 @@ void A_SkelMissile(mobj_t *actor)
 
   mo->x += mo->momx;
   mo->y += mo->momy;
+  P_SyncBlockThing(mo);
   P_SetTarget(&mo->tracer, actor->target);
 }
 
@@ -1654,9 +1656,11 @@ static dboolean PIT_VileCheck(mobj_t *thing)
         corpsehit->height = corpsehit->info->height;
         corpsehit->radius = corpsehit->info->radius;
         corpsehit->flags |= MF_SOLID;
+        P_SyncBlockThing(corpsehit);
         check = P_CheckPosition(corpsehit,corpsehit->x,corpsehit->y);
         corpsehit->height = height; // restore
         corpsehit->radius = radius; // restore                      //   ^
+        P_SyncBlockThing(corpsehit);
         corpsehit->flags &= ~MF_SOLID;
       }                                                             //   |
                                                                     // phares
@@ -1697,7 +1701,7 @@ void A_VileChase(mobj_t* actor)
               // Call PIT_VileCheck to check
               // whether object is a corpse
               // that canbe raised.
-              if (!P_BlockThingsIterator(bx,by,PIT_VileCheck))
+              if (!P_BlockCorpsesIterator(bx,by,PIT_VileCheck))
                 {
       mobjinfo_t *info;
 
@@ -1719,6 +1723,7 @@ void A_VileChase(mobj_t* actor)
                     {
                       corpsehit->height = info->height; // fix Ghost bug
                       corpsehit->radius = info->radius; // fix Ghost bug
+                      P_SyncBlockThing(corpsehit);
                     }                                               // phares
 
       /* killough 7/18/98:
@@ -1857,6 +1862,7 @@ void A_VileAttack(mobj_t *actor)
   // move the fire between the vile and the player
   fire->x = actor->target->x - FixedMul (24*FRACUNIT, finecosine[an]);
   fire->y = actor->target->y - FixedMul (24*FRACUNIT, finesine[an]);
+  P_SyncBlockThing(fire);
   P_RadiusAttack(fire, actor, 70);
 }
 
@@ -44,6 +44,7 @@
 
 #include "p_inter.h"
 #include "p_enemy.h"
+#include "p_maputl.h"
 #include "hu_tracers.h"
 
 #ifdef __GNUG__
@@ -669,6 +670,7 @@ static void P_KillMobj(mobj_t *source, mobj_t *target)
 
   target->flags |= MF_CORPSE|MF_DROPOFF;
   target->height >>= 2;
+  P_AddBlockCorpse(target);
 
   if (compatibility_level == mbf_compatibility && 
       !prboom_comp[PC_MBF_REMOVE_THINKER_IN_KILLMOBJ].state)
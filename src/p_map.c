@@ -331,7 +331,7 @@ dboolean P_TeleportMove (mobj_t* thing,fixed_t x,fixed_t y, dboolean boss)
 
   for (bx=xl ; bx<=xh ; bx++)
     for (by=yl ; by<=yh ; by++)
-      if (!P_BlockThingsIterator(bx,by,PIT_StompThing))
+      if (!P_BlockThingsIteratorNear(bx,by,tmx,tmy,tmthing->radius,PIT_StompThing))
         return false;
 
   // the move is ok,
@@ -815,7 +815,7 @@ dboolean P_CheckPosition (mobj_t* thing,fixed_t x,fixed_t y)
 
   for (bx=xl ; bx<=xh ; bx++)
     for (by=yl ; by<=yh ; by++)
-      if (!P_BlockThingsIterator(bx,by,PIT_CheckThing))
+      if (!P_BlockThingsIteratorNear(bx,by,tmx,tmy,tmthing->radius,PIT_CheckThing))
         return false;
 
   // check lines
@@ -1971,6 +1971,7 @@ dboolean PIT_ChangeSector (mobj_t* thing)
     }
     thing->height = 0;
     thing->radius = 0;
+    P_SyncBlockThing(thing);
     if (colored_blood)
     {
       thing->flags |= MF_COLOREDBLOOD;
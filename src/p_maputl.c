@@ -218,6 +218,227 @@ void P_LineOpening(const line_t *linedef)
 // THING POSITION SETTING
 //
 
+//
+// Block thing mirror
+//
+// Every blockmap block keeps a packed copy of the position and radius of
+// the things linked into it, in the same order as the blocklinks chain but
+// reversed, so the head of the chain is the last entry. Collision checks
+// scan these instead of dereferencing every mobj on the chain. The copy is
+// updated wherever a chain is relinked (P_SetThingPosition and
+// P_UnsetThingPosition) and by P_SyncBlockThing where the game moves or
+// resizes a linked thing in place. If the copy and the chains ever disagree,
+// it is switched off until the next level.
+//
+// Each block also lists the corpses linked into it, for the Arch-Vile
+// search, in the same order as the chain. A thing is listed when it is
+// linked with MF_CORPSE set or killed in place (P_AddBlockCorpse) and stays
+// listed until it is unlinked, so the list may hold things that were raised
+// since, but never misses a corpse. Entries are ordered by link sequence
+// number, which is also the chain order.
+//
+
+typedef struct
+{
+  fixed_t x, y, radius;
+  mobj_t *mobj;
+  uint_64_t seq;        // blockthings_seq when linked
+} blockthing_t;
+
+typedef struct
+{
+  mobj_t *mobj;
+  uint_64_t seq;
+} blockcorpse_t;
+
+typedef struct
+{
+  blockthing_t *things;
+  int count, size;
+  blockcorpse_t *corpses;
+  int numcorpses, maxcorpses;
+} blockthings_t;
+
+static blockthings_t *blockthings;
+static int numblockthings;
+static int blockthings_changes;   // bumped whenever an entry moves
+static uint_64_t blockthings_seq;
+static dboolean blockthings_valid;
+
+void P_InitBlockThings(void)
+{
+  int i;
+
+  for (i = 0; i < numblockthings; i++)
+  {
+    free(blockthings[i].things);
+    free(blockthings[i].corpses);
+  }
+  free(blockthings);
+
+  numblockthings = bmapwidth * bmapheight;
+  blockthings = calloc(numblockthings, sizeof(*blockthings));
+  blockthings_valid = true;
+}
+
+static blockthing_t *P_FindBlockThing(mobj_t *thing, blockthings_t **block)
+{
+  int b, i;
+
+  // blockhint holds the low 16 bits of the block index
+  for (b = thing->blockhint; b < numblockthings; b += 0x10000)
+  {
+    for (i = blockthings[b].count; i-- > 0; )
+    {
+      if (blockthings[b].things[i].mobj == thing)
+      {
+        *block = &blockthings[b];
+        return &blockthings[b].things[i];
+      }
+    }
+  }
+
+  return NULL;
+}
+
+// Index of the first corpse in block with a sequence number >= seq
+static int P_FindBlockCorpse(const blockthings_t *block, uint_64_t seq)
+{
+  int lo = 0, hi = block->numcorpses;
+
+  while (lo < hi)
+  {
+    int mid = (lo + hi) / 2;
+
+    if (block->corpses[mid].seq < seq)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+static void P_InsertBlockCorpse(blockthings_t *block, const blockthing_t *entry)
+{
+  int i = P_FindBlockCorpse(block, entry->seq);
+
+  if (i < block->numcorpses && block->corpses[i].seq == entry->seq)
+    return;   // already listed
+
+  if (block->numcorpses == block->maxcorpses)
+  {
+    block->maxcorpses = block->maxcorpses ? block->maxcorpses * 2 : 8;
+    block->corpses = realloc(block->corpses, block->maxcorpses * sizeof(*block->corpses));
+  }
+
+  memmove(block->corpses + i + 1, block->corpses + i,
+          (block->numcorpses++ - i) * sizeof(*block->corpses));
+  block->corpses[i].mobj = entry->mobj;
+  block->corpses[i].seq = entry->seq;
+  blockthings_changes++;
+}
+
+static void P_AddBlockThing(mobj_t *thing, int b)
+{
+  blockthings_t *block;
+  blockthing_t *entry;
+
+  if (!blockthings_valid)
+    return;
+
+  if (b >= numblockthings)
+  {
+    blockthings_valid = false;
+    return;
+  }
+
+  block = &blockthings[b];
+  if (block->count == block->size)
+  {
+    block->size = block->size ? block->size * 2 : 8;
+    block->things = realloc(block->things, block->size * sizeof(*block->things));
+  }
+
+  entry = &block->things[block->count++];
+  entry->x = thing->x;
+  entry->y = thing->y;
+  entry->radius = thing->radius;
+  entry->mobj = thing;
+  entry->seq = blockthings_seq++;
+  thing->blockhint = (unsigned short)b;
+  blockthings_changes++;
+
+  if (thing->flags & MF_CORPSE)
+    P_InsertBlockCorpse(block, entry);
+}
+
+static void P_RemoveBlockThing(mobj_t *thing)
+{
+  blockthings_t *block;
+  blockthing_t *entry;
+
+  if (!blockthings_valid)
+    return;
+
+  if (!(entry = P_FindBlockThing(thing, &block)))
+  {
+    // unlinked twice, the chains are no longer what the copy says
+    blockthings_valid = false;
+    return;
+  }
+
+  if (block->numcorpses)
+  {
+    int i = P_FindBlockCorpse(block, entry->seq);
+
+    if (i < block->numcorpses && block->corpses[i].seq == entry->seq)
+      memmove(block->corpses + i, block->corpses + i + 1,
+              (--block->numcorpses - i) * sizeof(*block->corpses));
+  }
+
+  memmove(entry, entry + 1, (block->things + --block->count - entry) * sizeof(*entry));
+  blockthings_changes++;
+}
+
+//
+// P_AddBlockCorpse
+// Lists a thing that became a corpse without being relinked.
+//
+
+void P_AddBlockCorpse(mobj_t *thing)
+{
+  blockthings_t *block;
+  blockthing_t *entry;
+
+  if (!blockthings_valid || !thing->bprev)
+    return;
+
+  if ((entry = P_FindBlockThing(thing, &block)))
+    P_InsertBlockCorpse(block, entry);
+}
+
+//
+// P_SyncBlockThing
+// Refreshes the copy after thing->x, y or radius changed without a relink.
+//
+
+void P_SyncBlockThing(mobj_t *thing)
+{
+  blockthings_t *block;
+  blockthing_t *entry;
+
+  if (!blockthings_valid || !thing->bprev)
+    return;
+
+  if ((entry = P_FindBlockThing(thing, &block)))
+  {
+    entry->x = thing->x;
+    entry->y = thing->y;
+    entry->radius = thing->radius;
+  }
+}
+
 //
 // P_UnsetThingPosition
 // Unlinks a thing from block map and sectors.
@@ -273,6 +494,8 @@ void P_UnsetThingPosition (mobj_t *thing)
        */
 
       mobj_t *bnext, **bprev = thing->bprev;
+      if (bprev)
+        P_RemoveBlockThing(thing);
       if (bprev && (*bprev = bnext = thing->bnext))  // unlink from block map
         bnext->bprev = bprev;
     }
@@ -338,6 +561,7 @@ void P_SetThingPosition(mobj_t *thing)
           bnext->bprev = &thing->bnext;
         thing->bprev = link;
         *link = thing;
+        P_AddBlockThing(thing, blocky*bmapwidth+blockx);
       }
       else        // thing is off the map
         thing->bnext = NULL, thing->bprev = NULL;
@@ -412,6 +636,97 @@ dboolean P_BlockThingsIterator(int x, int y, dboolean func(mobj_t*))
   return true;
 }
 
+//
+// P_BlockThingsIteratorNear
+//
+// Same as P_BlockThingsIterator, but skips the things whose x or y is
+// dist + radius or more away from (cx, cy) without calling func. Only for
+// functions that return true without side effects for such things.
+//
+
+dboolean P_BlockThingsIteratorNear(int x, int y, fixed_t cx, fixed_t cy,
+                                   fixed_t dist, dboolean func(mobj_t*))
+{
+  blockthings_t *block;
+  int i, changes;
+
+  if (x<0 || y<0 || x>=bmapwidth || y>=bmapheight)
+    return true;
+
+  if (!blockthings_valid || y*bmapwidth+x >= numblockthings)
+    return P_BlockThingsIterator(x, y, func);
+
+  block = &blockthings[y*bmapwidth+x];
+  changes = blockthings_changes;
+
+  for (i = block->count; i-- > 0; )
+  {
+    const blockthing_t *entry = &block->things[i];
+    fixed_t blockdist = entry->radius + dist;
+    mobj_t *mobj;
+
+    if (D_abs(entry->x - cx) >= blockdist || D_abs(entry->y - cy) >= blockdist)
+      continue;
+
+    mobj = entry->mobj;
+    if (!func(mobj))
+      return false;
+
+    // func relinked things; carry on down the chain as the plain iterator
+    if (changes != blockthings_changes)
+    {
+      while ((mobj = mobj->bnext))
+        if (!func(mobj))
+          return false;
+      return true;
+    }
+  }
+
+  return true;
+}
+
+//
+// P_BlockCorpsesIterator
+//
+// Same as P_BlockThingsIterator, but only calls func for the things in the
+// block's corpse list. Only for functions that return true without side
+// effects for things without MF_CORPSE.
+//
+
+dboolean P_BlockCorpsesIterator(int x, int y, dboolean func(mobj_t*))
+{
+  blockthings_t *block;
+  int i, changes;
+
+  if (x<0 || y<0 || x>=bmapwidth || y>=bmapheight)
+    return true;
+
+  if (!blockthings_valid || y*bmapwidth+x >= numblockthings)
+    return P_BlockThingsIterator(x, y, func);
+
+  block = &blockthings[y*bmapwidth+x];
+  changes = blockthings_changes;
+
+  for (i = block->numcorpses; i-- > 0; )
+  {
+    mobj_t *mobj = block->corpses[i].mobj;
+
+    if (!func(mobj))
+      return false;
+
+    // func relinked or killed things; carry on down the chain
+    if (changes != blockthings_changes)
+    {
+      while ((mobj = mobj->bnext))
+        if (!func(mobj))
+          return false;
+      return true;
+    }
+  }
+
+  return true;
+}
+
 //
 // INTERCEPT ROUTINES
 //
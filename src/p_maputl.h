@@ -82,6 +82,12 @@ void    P_UnsetThingPosition(mobj_t *thing);
 void    P_SetThingPosition(mobj_t *thing);
 dboolean P_BlockLinesIterator (int x, int y, dboolean func(line_t *));
 dboolean P_BlockThingsIterator(int x, int y, dboolean func(mobj_t *));
+dboolean P_BlockThingsIteratorNear(int x, int y, fixed_t cx, fixed_t cy,
+                                   fixed_t dist, dboolean func(mobj_t *));
+dboolean P_BlockCorpsesIterator(int x, int y, dboolean func(mobj_t *));
+void    P_InitBlockThings(void);
+void    P_SyncBlockThing(mobj_t *thing);
+void    P_AddBlockCorpse(mobj_t *thing);
 dboolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
                        int flags, dboolean trav(intercept_t *));
 
@@ -1540,6 +1540,7 @@ void P_CheckMissileSpawn (mobj_t* th)
 
   th->x += (th->momx>>1);
   th->y += (th->momy>>1);
+  P_SyncBlockThing(th);
   th->z += (th->momz>>1);
 
   // killough 8/12/98: for non-missile objects (e.g. grenades)
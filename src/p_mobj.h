@@ -369,6 +369,9 @@ typedef struct mobj_s
     angle_t             pitch;  // orientation
     int index;
     short patch_width;
+    // low 16 bits of the blockmap block the thing is linked into, see
+    // P_SyncBlockThing; sits in what was padding so savegames keep their layout
+    unsigned short blockhint;
 
     int iden_nums;		// hi word stores thing num, low word identifier num
 
@@ -57,6 +57,7 @@
 #include "g_overflow.h"
 #include "am_map.h"
 #include "e6y.h"//e6y
+#include "i_system.h"
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -1132,44 +1133,48 @@ static void P_LoadZSegs (const byte *data)
   }
 }
 
-// MB 2020-03-01: Fix endianess for 32-bit ZDoom nodes
-// https://zdoom.org/wiki/Node#ZDoom_extended_nodes
-static void P_LoadZNodes(int lump, int glnodes, int compressed)
+//
+// Level preloading state, see P_PreloadLevel
+//
+
+int level_preload = 1;
+
+static struct
 {
-  byte *data;
-  unsigned int i;
-  int len;
+  int lumpnum, gl_lumpnum;
+  int stage;
+  int index;
 
-  unsigned int orgVerts, newVerts;
-  unsigned int numSubs, currSeg;
-  unsigned int numSegs;
-  unsigned int numNodes;
-  vertex_t *newvertarray = NULL;
-#ifdef HAVE_LIBZ
-  byte *output;
-#endif
+  // map lumps held locked until P_SetupLevel has read them
+  int locked[ML_BLOCKMAP + 1 + ML_GL_NODES + 1];
+  int numlocked;
 
-  data = (byte*)W_CacheLumpNum(lump);
-  len =  W_LumpLength(lump);
+  // ZNOD nodes inflated ahead of time
+  byte *znodes;
+  int znodes_lump;
+  int znodes_len;
+} preload = { -1, -1 };
 
-  if (compressed == ZDOOM_ZNOD_NODES)
-  {
 #ifdef HAVE_LIBZ
-	int outlen, err;
+// Inflates a compressed ZNOD nodes lump into a new PU_STATIC buffer.
+static byte *P_InflateZNodes(const byte *data, int len, int *outlen)
+{
+	byte *output;
+	int err, size;
 	z_stream *zstream;
 
 	// first estimate for compression rate:
 	// output buffer size == 2.5 * input size
-	outlen = 2.5 * len;
-	output = Z_Malloc(outlen, PU_STATIC, 0);
+	size = 2.5 * len;
+	output = Z_Malloc(size, PU_STATIC, 0);
 
 	// initialize stream state for decompression
 	zstream = malloc(sizeof(*zstream));
 	memset(zstream, 0, sizeof(*zstream));
-	zstream->next_in = data + 4;
+	zstream->next_in = (byte *)data + 4;
 	zstream->avail_in = len - 4;
 	zstream->next_out = output;
-	zstream->avail_out = outlen;
+	zstream->avail_out = size;
 
 	if (inflateInit(zstream) != Z_OK)
 	    I_Error("P_LoadZNodes: Error during ZDoom nodes decompression initialization!");
@@ -1177,11 +1182,11 @@ static void P_LoadZNodes(int lump, int glnodes, int compressed)
 	// resize if output buffer runs full
 	while ((err = inflate(zstream, Z_SYNC_FLUSH)) == Z_OK)
 	{
-	    int outlen_old = outlen;
-	    outlen = 2 * outlen_old;
-	    output = realloc(output, outlen);
-	    zstream->next_out = output + outlen_old;
-	    zstream->avail_out = outlen - outlen_old;
+	    int size_old = size;
+	    size = 2 * size_old;
+	    output = realloc(output, size);
+	    zstream->next_out = output + size_old;
+	    zstream->avail_out = size - size_old;
 	}
 
 	if (err != Z_STREAM_END)
@@ -1190,15 +1195,54 @@ static void P_LoadZNodes(int lump, int glnodes, int compressed)
 	lprintf(LO_INFO, "P_LoadZNodes: ZDoom nodes compression ratio %.3f\n",
 	        (float)zstream->total_out/zstream->total_in);
 
-	data = output;
-	len = zstream->total_out;
+	*outlen = zstream->total_out;
 
 	if (inflateEnd(zstream) != Z_OK)
 	    I_Error("P_LoadZNodes: Error during ZDoom nodes decompression shut-down!");
 
+	free(zstream);
+
+	return output;
+}
+#endif
+
+// MB 2020-03-01: Fix endianess for 32-bit ZDoom nodes
+// https://zdoom.org/wiki/Node#ZDoom_extended_nodes
+static void P_LoadZNodes(int lump, int glnodes, int compressed)
+{
+  byte *data;
+  unsigned int i;
+  int len;
+
+  unsigned int orgVerts, newVerts;
+  unsigned int numSubs, currSeg;
+  unsigned int numSegs;
+  unsigned int numNodes;
+  vertex_t *newvertarray = NULL;
+#ifdef HAVE_LIBZ
+  byte *output;
+#endif
+
+  data = (byte*)W_CacheLumpNum(lump);
+  len =  W_LumpLength(lump);
+
+  if (compressed == ZDOOM_ZNOD_NODES)
+  {
+#ifdef HAVE_LIBZ
+	// use the nodes inflated during the intermission if we have them
+	if (preload.znodes && preload.znodes_lump == lump)
+	{
+	    output = preload.znodes;
+	    len = preload.znodes_len;
+	    preload.znodes = NULL;
+	}
+	else
+	    output = P_InflateZNodes(data, len, &len);
+
+	data = output;
+
 	// release the original data lump
 	W_UnlockLumpNum(lump);
-	free(zstream);
 #else
 	I_Error("P_LoadZNodes: Compressed ZDoom nodes are not supported!");
 #endif
@@ -2597,6 +2641,190 @@ void P_InitSubsectorsLines(void)
 //
 // killough 5/3/98: reformatted, cleaned up
 
+//
+// P_PreloadLevel
+//
+// Speculatively reads the next map while the intermission is shown, so
+// P_SetupLevel finds its lumps in the cache instead of going to storage.
+// Map lumps are kept locked until P_SetupLevel is done with them, ZDoom
+// nodes are inflated ahead of time, and the flats and wall patches the map
+// refers to are warmed the way R_PrecacheLevel does it.
+//
+// The work runs from the game ticker in slices of PRELOAD_SLICE_MS, since
+// neither the zone allocator nor the lump cache may be used from another
+// thread. Nothing here touches game state, so demos and netgames are not
+// affected.
+//
+
+#define PRELOAD_SLICE_MS 8
+
+enum {
+  PRELOAD_NONE,
+  PRELOAD_LUMPS,
+  PRELOAD_GLLUMPS,
+  PRELOAD_ZNODES,
+  PRELOAD_FLATS,
+  PRELOAD_TEXTURES,
+  PRELOAD_DONE
+};
+
+// Drops whatever was preloaded, also used when no level follows
+void P_ReleasePreload(void)
+{
+  while (preload.numlocked > 0)
+    W_UnlockLumpNum(preload.locked[--preload.numlocked]);
+
+  if (preload.znodes)
+  {
+    Z_Free(preload.znodes);
+    preload.znodes = NULL;
+  }
+
+  preload.stage = PRELOAD_NONE;
+}
+
+static void P_MapLumpNames(int episode, int map, char *lumpname, char *gl_lumpname)
+{
+  if (gamemode == commercial)
+  {
+    snprintf(lumpname, 9, "map%02d", map);           // killough 1/24/98: simplify
+    snprintf(gl_lumpname, 9, "gl_map%02d", map);    // figgi
+  }
+  else
+  {
+    snprintf(lumpname, 9, "E%dM%d", episode, map);   // killough 1/24/98: simplify
+    snprintf(gl_lumpname, 9, "GL_E%iM%i", episode, map); // figgi
+  }
+}
+
+void P_PreloadLevel(int episode, int map)
+{
+  char lumpname[9];
+  char gl_lumpname[9];
+
+  P_ReleasePreload();
+
+  if (!level_preload || timingdemo)
+    return;
+
+  P_MapLumpNames(episode, map, lumpname, gl_lumpname);
+
+  preload.lumpnum = W_CheckNumForName(lumpname);
+  preload.gl_lumpnum = W_CheckNumForName(gl_lumpname);
+
+  if (preload.lumpnum == -1 || preload.lumpnum + ML_BLOCKMAP >= numlumps)
+    return;
+  if (preload.gl_lumpnum != -1 && preload.gl_lumpnum + ML_GL_NODES >= numlumps)
+    preload.gl_lumpnum = -1;
+
+  preload.stage = PRELOAD_LUMPS;
+  preload.index = 0;
+}
+
+// warms the cache without holding on to the lump
+static void P_PreloadCacheLump(int lump)
+{
+  W_CacheLumpNum(lump);
+  W_UnlockLumpNum(lump);
+}
+
+static void P_PreloadLump(int lump)
+{
+  W_LockLumpNum(lump);
+  preload.locked[preload.numlocked++] = lump;
+}
+
+void P_PreloadTicker(void)
+{
+  int start = I_GetTime_MS();
+
+  while (preload.stage != PRELOAD_NONE && preload.stage != PRELOAD_DONE &&
+         I_GetTime_MS() - start < PRELOAD_SLICE_MS)
+  {
+    switch (preload.stage)
+    {
+      case PRELOAD_LUMPS:
+        if (++preload.index <= ML_BLOCKMAP)
+          P_PreloadLump(preload.lumpnum + preload.index);
+        else
+          preload.stage++, preload.index = 0;
+        break;
+
+      case PRELOAD_GLLUMPS:
+        if (preload.gl_lumpnum != -1 && ++preload.index <= ML_GL_NODES)
+          P_PreloadLump(preload.gl_lumpnum + preload.index);
+        else
+          preload.stage++, preload.index = 0;
+        break;
+
+      case PRELOAD_ZNODES:
+#ifdef HAVE_LIBZ
+        if (CheckForIdentifier(preload.lumpnum + ML_NODES, (const byte *)"ZNOD", 4))
+        {
+          preload.znodes_lump = preload.lumpnum + ML_NODES;
+          preload.znodes = P_InflateZNodes(W_CacheLumpNum(preload.znodes_lump),
+            W_LumpLength(preload.znodes_lump), &preload.znodes_len);
+          W_UnlockLumpNum(preload.znodes_lump);
+        }
+#endif
+        preload.stage++;
+        break;
+
+      case PRELOAD_FLATS:
+        {
+          int lump = preload.lumpnum + ML_SECTORS;
+          const mapsector_t *ms = W_CacheLumpNum(lump);
+          int count = W_LumpLength(lump) / sizeof(mapsector_t);
+          int flat;
+
+          // a few sectors per step keeps the slices short
+          int end = MIN(count, preload.index + 64);
+
+          for (ms += preload.index; preload.index < end; preload.index++, ms++)
+          {
+            if ((flat = (W_CheckNumForName)(ms->floorpic, ns_flats)) != -1)
+              P_PreloadCacheLump(flat);
+            if ((flat = (W_CheckNumForName)(ms->ceilingpic, ns_flats)) != -1)
+              P_PreloadCacheLump(flat);
+          }
+          W_UnlockLumpNum(lump);
+
+          if (preload.index >= count)
+            preload.stage++, preload.index = 0;
+        }
+        break;
+
+      case PRELOAD_TEXTURES:
+        {
+          int lump = preload.lumpnum + ML_SIDEDEFS;
+          const mapsidedef_t *msd = W_CacheLumpNum(lump);
+          int count = W_LumpLength(lump) / sizeof(mapsidedef_t);
+
+          int end = MIN(count, preload.index + 64);
+
+          for (msd += preload.index; preload.index < end; preload.index++, msd++)
+          {
+            const char *names[3];
+            int j, k, texnum;
+
+            names[0] = msd->toptexture;
+            names[1] = msd->bottomtexture;
+            names[2] = msd->midtexture;
+            for (j = 0; j < 3; j++)
+              if ((texnum = R_CheckTextureNumForName(names[j])) > 0)
+                for (k = textures[texnum]->patchcount; --k >= 0; )
+                  P_PreloadCacheLump(textures[texnum]->patches[k].patch);
+          }
+          W_UnlockLumpNum(lump);
+
+          if (preload.index >= count)
+            preload.stage++, preload.index = 0;
+        }
+        break;
+    }
+  }
+}
+
 // [FG] current map lump number
 int maplumpnum = -1;
 
@@ -2642,16 +2870,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
   //    W_Reload ();     killough 1/31/98: W_Reload obsolete
 
   // find map name
-  if (gamemode == commercial)
-  {
-    snprintf(lumpname, sizeof(lumpname), "map%02d", map);           // killough 1/24/98: simplify
-    snprintf(gl_lumpname, sizeof(gl_lumpname), "gl_map%02d", map);    // figgi
-  }
-  else
-  {
-    snprintf(lumpname, sizeof(lumpname), "E%dM%d", episode, map);   // killough 1/24/98: simplify
-    snprintf(gl_lumpname, sizeof(gl_lumpname), "GL_E%iM%i", episode, map); // figgi
-  }
+  P_MapLumpNames(episode, map, lumpname, gl_lumpname);
 
   lumpnum = W_GetNumForName(lumpname);
   gl_lumpnum = W_CheckNumForName(gl_lumpname); // figgi
@@ -2733,6 +2952,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
   {
     memset(blocklinks, 0, bmapwidth*bmapheight*sizeof(*blocklinks));
   }
+  P_InitBlockThings();
 
   if (nodesVersion > 0)
   {
@@ -2833,6 +3053,9 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
 
   P_MapEnd();
 
+  // release whatever the intermission preloaded
+  P_ReleasePreload();
+
   // preload graphics
   if (precache)
     R_PrecacheLevel();
@@ -43,6 +43,12 @@
 void P_SetupLevel(int episode, int map, int playermask, skill_t skill);
 void P_Init(void);               /* Called by startup code. */
 
+/* Speculative loading of the next map during the intermission */
+extern int level_preload;
+void P_PreloadLevel(int episode, int map);
+void P_PreloadTicker(void);
+void P_ReleasePreload(void);
+
 extern const byte *rejectmatrix;   /* for fast sight rejection -  cph - const* */
 
 /* killough 3/1/98: change blockmap from "short" to "long" offsets: */
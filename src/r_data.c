@@ -45,6 +45,7 @@
 #include "p_tick.h"
 
 #include "m_io.h"
+#include "v_video.h"
 
 //
 // Graphics.
@@ -416,6 +417,67 @@ int tran_filter_pct = 66;       // filter percent
 
 #define TSC 12        /* number of fixed point digits in filter percent */
 
+// tranmap.dat holds several maps, newest first, so switching the filter
+// percentage or between wads with different palettes doesn't rebuild them
+#define TRANMAP_CACHE_ENTRIES 8
+
+typedef struct {
+  unsigned char pct;
+  unsigned char playpal[256*3];
+} tranmap_cache_t;
+
+static byte *built_tranmap;
+
+// Looks for the map for cache in fp, returns true and fills tranmap if found
+static dboolean R_ReadTranMapCache(FILE *fp, const tranmap_cache_t *cache, byte *tranmap)
+{
+  tranmap_cache_t entry;
+  int i;
+
+  for (i = 0; i < TRANMAP_CACHE_ENTRIES; i++)
+  {
+    if (fread(&entry, 1, sizeof entry, fp) != sizeof entry)
+      break;
+
+    if (!memcmp(&entry, cache, sizeof entry))
+      return fread(tranmap, 256, 256, fp) == 256;
+
+    if (fseek(fp, 256*256, SEEK_CUR))
+      break;
+  }
+
+  return false;
+}
+
+// Puts the new map in front of the cached ones, dropping the oldest
+static void R_WriteTranMapCache(const char *fname, const tranmap_cache_t *cache, const byte *tranmap)
+{
+  const size_t entrysize = sizeof(tranmap_cache_t) + 256*256;
+  byte *old = NULL;
+  size_t oldsize = 0;
+  FILE *fp;
+
+  if ((fp = M_fopen(fname, "rb")) != NULL)
+  {
+    old = malloc((TRANMAP_CACHE_ENTRIES - 1) * entrysize);
+    while (oldsize < TRANMAP_CACHE_ENTRIES - 1 &&
+           fread(old + oldsize * entrysize, entrysize, 1, fp) == 1)
+      oldsize++;
+    fclose(fp);
+  }
+
+  if ((fp = M_fopen(fname, "wb")) != NULL)
+  {
+    fwrite(cache, 1, sizeof *cache, fp);
+    fwrite(tranmap, 256, 256, fp);
+    if (oldsize)
+      fwrite(old, entrysize, oldsize, fp);
+    fclose(fp);
+  }
+
+  free(old);
+}
+
 void R_InitTranMap(int progress)
 {
   int lump = W_CheckNumForName("TRANMAP");
@@ -431,26 +493,31 @@ void R_InitTranMap(int progress)
 
       char *fname;
       int fnlen;
-      struct {
-        unsigned char pct;
-        unsigned char playpal[256*3];
-      } cache;
+      tranmap_cache_t cache;
       FILE *cachefp;
+      dboolean cached = false;
 
       fnlen = doom_snprintf(NULL, 0, "%s/tranmap.dat", I_DoomExeDir());
       fname = malloc(fnlen+1);
       doom_snprintf(fname, fnlen+1, "%s/tranmap.dat", I_DoomExeDir());
-      cachefp = M_fopen(fname, "rb");
 
-      main_tranmap = my_tranmap = Z_Malloc(256*256, PU_STATIC, 0);  // killough 4/11/98
+      // reuse the map built for an earlier percentage
+      if (!built_tranmap)
+        built_tranmap = Z_Malloc(256*256, PU_STATIC, 0);
+      main_tranmap = my_tranmap = built_tranmap;  // killough 4/11/98
+
+      cache.pct = tran_filter_pct;
+      memcpy(cache.playpal, playpal, sizeof cache.playpal);
 
       // Use cached translucency filter if it's available
 
-      if (!cachefp ||
-          fread(&cache, 1, sizeof cache, cachefp) != sizeof cache ||
-          cache.pct != tran_filter_pct ||
-          memcmp(cache.playpal, playpal, sizeof cache.playpal) ||
-          fread(my_tranmap, 256, 256, cachefp) != 256 ) // killough 4/11/98
+      if ((cachefp = M_fopen(fname, "rb")) != NULL)
+        {
+          cached = R_ReadTranMapCache(cachefp, &cache, my_tranmap);
+          fclose(cachefp);              // killough 11/98: fix filehandle leak
+        }
+
+      if (!cached)
         {
           long pal[3][256], tot[256], pal_w1[3][256];
           long w1 = ((unsigned long) tran_filter_pct<<TSC)/100;
@@ -480,7 +547,11 @@ void R_InitTranMap(int progress)
             while (--i>=0);
           }
 
-          // Next, compute all entries using minimum arithmetic.
+          // Next, compute all entries using minimum arithmetic. Only the
+          // colors that can be nearest to the blend are tried; scanning
+          // them from the top keeps the highest index on ties, as before.
+
+          V_InitColorMatch(playpal);
 
           {
             int i,j;
@@ -495,33 +566,28 @@ void R_InitTranMap(int progress)
                   lprintf(LO_INFO,".");
                 for (j=0;j<256;j++,tp++)
                   {
-                    register int color = 255;
+                    register int color;
                     register long err;
                     long r = pal_w1[0][j] + r1;
                     long g = pal_w1[1][j] + g1;
                     long b = pal_w1[2][j] + b1;
                     long best = LONG_MAX;
-                    do
-                      if ((err = tot[color] - pal[0][color]*r
-                          - pal[1][color]*g - pal[2][color]*b) < best)
-                        best = err, *tp = color;
-                    while (--color >= 0);
+                    int k;
+                    const byte *list = V_ColorCandidates(r>>TSC, g>>TSC, b>>TSC, &k);
+                    while (--k >= 0)
+                      {
+                        color = list[k];
+                        if ((err = tot[color] - pal[0][color]*r
+                            - pal[1][color]*g - pal[2][color]*b) < best)
+                          best = err, *tp = color;
+                      }
                   }
               }
           }
-          if ((cachefp = M_fopen(fname,"wb")) != NULL) // write out the cached translucency map
-            {
-              cache.pct = tran_filter_pct;
-              memcpy(cache.playpal, playpal, sizeof cache.playpal);
-              fseek(cachefp, 0, SEEK_SET);
-              fwrite(&cache, 1, sizeof cache, cachefp);
-              fwrite(main_tranmap, 256, 256, cachefp);
-              // CPhipps - leave close for a few lines...
-            }
-        }
 
-      if (cachefp)              // killough 11/98: fix filehandle leak
-        fclose(cachefp);
+          // write out the cached translucency map
+          R_WriteTranMapCache(fname, &cache, my_tranmap);
+        }
 
       free(fname);
 
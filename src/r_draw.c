@@ -62,6 +62,10 @@ int  viewheight;
 int  viewwindowx;
 int  viewwindowy;
 
+// dynamic resolution: source column of each view window column when the
+// view is rendered narrower than the window (see R_StretchViewWindow)
+static int *stretchx;
+
 // Color tables for different players,
 //  translate a limited part to another
 //  (color ramps used for  suit colors).
@@ -852,6 +856,9 @@ void R_InitBuffersRes(void)
   short_tempbuf = calloc(1, (SCREENHEIGHT * 4) * sizeof(*short_tempbuf));
   int_tempbuf = calloc(1, (SCREENHEIGHT * 4) * sizeof(*int_tempbuf));
 
+  if (stretchx) free(stretchx);
+  stretchx = calloc(1, SCREENWIDTH * sizeof(*stretchx));
+
   temp_x = 0;
 }
 
@@ -892,6 +899,63 @@ void R_InitBuffer(int width, int height)
   }
 }
 
+//
+// R_InitViewStretch
+// Maps each view window column to the rendered column it is widened
+//  from by R_StretchViewWindow.
+//
+
+void R_InitViewStretch(void)
+{
+  int i;
+
+  for (i=0; i<scaledviewwidth; i++)
+    stretchx[i] = i * viewwidth / scaledviewwidth;
+}
+
+//
+// R_StretchViewWindow
+// Dynamic resolution: widens the viewwidth columns the view was rendered
+//  at to the full scaledviewwidth window. Every destination column is at
+//  or right of its source, so rows are stretched in place from the right.
+//
+
+void R_StretchViewWindow(void)
+{
+  int x, y;
+
+  if (viewwidth == scaledviewwidth || V_GetMode() == VID_MODEGL)
+    return;
+
+  switch (V_GetPixelDepth())
+  {
+  case 1:
+    for (y = 0; y < viewheight; y++)
+    {
+      byte *row = drawvars.byte_topleft + y * drawvars.byte_pitch;
+      for (x = scaledviewwidth - 1; x > 0; x--)
+        row[x] = row[stretchx[x]];
+    }
+    break;
+  case 2:
+    for (y = 0; y < viewheight; y++)
+    {
+      unsigned short *row = drawvars.short_topleft + y * drawvars.short_pitch;
+      for (x = scaledviewwidth - 1; x > 0; x--)
+        row[x] = row[stretchx[x]];
+    }
+    break;
+  case 4:
+    for (y = 0; y < viewheight; y++)
+    {
+      unsigned int *row = drawvars.int_topleft + y * drawvars.int_pitch;
+      for (x = scaledviewwidth - 1; x > 0; x--)
+        row[x] = row[stretchx[x]];
+    }
+    break;
+  }
+}
+
 //
 // R_FillBackScreen
 // Fills the back screen with a pattern
@@ -978,9 +1042,12 @@ void R_FillBackScreen (void)
 void R_VideoErase(int x, int y, int count)
 {
   if (V_GetMode() != VID_MODEGL)
+  {
     memcpy(screens[0].data+y*screens[0].byte_pitch+x*V_GetPixelDepth(),
            screens[1].data+y*screens[1].byte_pitch+x*V_GetPixelDepth(),
            count*V_GetPixelDepth());   // LFB copy.
+    V_MarkRect(x, y, count, 1);
+  }
 }
 
 //
@@ -1025,7 +1092,7 @@ void R_DrawViewBorder(void)
   // copy sides
   for (i = top; i < (top+viewheight); i++) {
     R_VideoErase (0, i, side);
-    R_VideoErase (viewwidth+side, i, side);
+    R_VideoErase (scaledviewwidth+side, i, side);
   }
 
   // copy bottom
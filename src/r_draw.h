@@ -158,6 +158,10 @@ void R_InitBuffer(int width, int height);
 
 void R_InitBuffersRes(void);
 
+// Dynamic resolution: widens the rendered view to the view window.
+void R_InitViewStretch(void);
+void R_StretchViewWindow(void);
+
 // Initialize color translation tables, for player rendering etc.
 void R_InitTranslationTables(void);
 
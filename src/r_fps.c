@@ -49,17 +49,38 @@ typedef enum
 {
   INTERP_SectorFloor,
   INTERP_SectorCeiling,
-  INTERP_Vertex,
   INTERP_WallPanning,
   INTERP_FloorPanning,
-  INTERP_CeilingPanning
+  INTERP_CeilingPanning,
+  INTERP_NUMTYPES
 } interpolation_type_e;
 
+//
+// Interpolations are kept in one store per type. A store holds flat arrays
+// with comps entries per interpolation: the addresses of the interpolated
+// fields and their values at the last tic (old) and while a frame is being
+// drawn (bak). Lerping, restoring and saving are then the same branch-free
+// loop over contiguous arrays for every type. The INTERP_ fields of the
+// owning sector or side hold the index in the store plus one.
+//
+
 typedef struct
 {
-  interpolation_type_e type;
-  void *address;
-} interpolation_t;
+  int num, max;
+  int comps;          // fields per interpolation
+  void **owner;       // sector_t or side_t
+  fixed_t **field;    // num * comps
+  fixed_t *old;       // num * comps
+  fixed_t *bak;       // num * comps
+} interp_store_t;
+
+static interp_store_t interp_stores[INTERP_NUMTYPES] = {
+  {0, 0, 1}, // INTERP_SectorFloor
+  {0, 0, 1}, // INTERP_SectorCeiling
+  {0, 0, 2}, // INTERP_WallPanning
+  {0, 0, 2}, // INTERP_FloorPanning
+  {0, 0, 2}, // INTERP_CeilingPanning
+};
 
 int interpolation_maxobjects;
 
@@ -67,7 +88,7 @@ static int numinterpolations = 0;
 
 tic_vars_t tic_vars;
 
-static void R_DoAnInterpolation (int i, fixed_t smoothratio);
+static void R_DoInterpolations(fixed_t smoothratio);
 
 extern int realtic_clock_rate;
 void D_Display(fixed_t frac);
@@ -77,16 +98,101 @@ void M_ChangeUncappedFrameRate(void)
   movement_smooth = (singletics ? false : movement_smooth_default);
 }
 
+//
+// Frame pacer
+//
+// With uncapped_fps_limit set, every uncapped frame is held back until its
+// deadline before it is presented. I_uSleep covers most of the wait and the
+// last FRAME_SPIN_US are spun, since a sleep can overshoot by a scheduler
+// slice. Frame times of all presented frames are kept as histograms for the
+// idrate overlay and the timedemo report.
+//
+
+#define FRAME_SPIN_US  1500
+#define FRAME_STALL_US 1000000  // level loads and such, not frame times
+
+int uncapped_fps_limit;
+
+frame_stats_t frame_stats_window;
+frame_stats_t frame_stats_run;
+
+static uint_64_t frame_last_us;
+static uint_64_t frame_deadline_us;
+
+void R_ResetFrameStats(frame_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+}
+
+static void R_AddFrameStat(frame_stats_t *stats, unsigned int us)
+{
+  stats->hist[MIN(us / FRAME_HIST_STEP_US, FRAME_HIST_SIZE - 1)]++;
+  stats->count++;
+  if (us > stats->max_us)
+    stats->max_us = us;
+}
+
+// Upper edge of the bucket holding the pct'th percentile, in microseconds
+unsigned int R_FrameStatsPercentile(const frame_stats_t *stats, int pct)
+{
+  unsigned int target = (unsigned int)(((uint_64_t)stats->count * pct + 99) / 100);
+  unsigned int sum = 0;
+  int i;
+
+  if (!stats->count)
+    return 0;
+
+  for (i = 0; i < FRAME_HIST_SIZE - 1; i++)
+  {
+    sum += stats->hist[i];
+    if (sum >= target)
+      return MIN((i + 1) * FRAME_HIST_STEP_US, stats->max_us);
+  }
+
+  return stats->max_us;
+}
+
+void R_PaceFrame(void)
+{
+  uint_64_t now = I_GetTime_US();
+
+  if (movement_smooth && uncapped_fps_limit > 0 && !timingdemo && !fastdemo)
+  {
+    uint_64_t period = 1000000 / MAX(uncapped_fps_limit, TICRATE);
+
+    // restart the schedule after a stall or a clock jump
+    frame_deadline_us += period;
+    if (frame_deadline_us + period < now || frame_deadline_us > now + period)
+      frame_deadline_us = now;
+
+    while (frame_deadline_us > now + FRAME_SPIN_US)
+    {
+      I_uSleep((unsigned long)(frame_deadline_us - now - FRAME_SPIN_US));
+      now = I_GetTime_US();
+    }
+    while (now < frame_deadline_us)
+      now = I_GetTime_US();
+  }
+
+  if (frame_last_us && now - frame_last_us < FRAME_STALL_US)
+  {
+    R_AddFrameStat(&frame_stats_window, (unsigned int)(now - frame_last_us));
+    R_AddFrameStat(&frame_stats_run, (unsigned int)(now - frame_last_us));
+  }
+  frame_last_us = now;
+}
+
+// Starts the next frame time from now, after waits that are not frames
+void R_ResetFramePacer(void)
+{
+  frame_last_us = 0;
+}
+
 void R_InitInterpolation(void)
 {
   tic_vars.msec = realtic_clock_rate * TICRATE / 100000.0f;
 }
 
-typedef fixed_t fixed2_t[2];
-static fixed2_t *oldipos;
-static fixed2_t *bakipos;
-static interpolation_t *curipos;
-
 static dboolean NoInterpolateView;
 static dboolean didInterp;
 dboolean WasRenderedInTryRunTics;
@@ -174,15 +280,10 @@ void R_InterpolateView(player_t *player, fixed_t frac)
 
   if (!paused && movement_smooth)
   {
-    int i;
-
     didInterp = tic_vars.frac != FRACUNIT;
     if (didInterp)
     {
-      for (i = numinterpolations - 1; i >= 0; i--)
-      {
-        R_DoAnInterpolation (i, tic_vars.frac);
-      }
+      R_DoInterpolations(tic_vars.frac);
     }
   }
 }
@@ -192,259 +293,164 @@ void R_ResetViewInterpolation ()
   NoInterpolateView = true;
 }
 
-static void R_CopyInterpToOld (int i)
+static int *R_InterpolationIndex(interpolation_type_e type, void *posptr)
 {
-  switch (curipos[i].type)
+  switch (type)
   {
   case INTERP_SectorFloor:
-    oldipos[i][0] = ((sector_t*)curipos[i].address)->floorheight;
-    break;
+    return &((sector_t*)posptr)->INTERP_SectorFloor;
   case INTERP_SectorCeiling:
-    oldipos[i][0] = ((sector_t*)curipos[i].address)->ceilingheight;
-    break;
-  case INTERP_Vertex:
-    oldipos[i][0] = ((vertex_t*)curipos[i].address)->x;
-    oldipos[i][1] = ((vertex_t*)curipos[i].address)->y;
-    break;
+    return &((sector_t*)posptr)->INTERP_SectorCeiling;
   case INTERP_WallPanning:
-    oldipos[i][0] = ((side_t*)curipos[i].address)->rowoffset;
-    oldipos[i][1] = ((side_t*)curipos[i].address)->textureoffset;
-    break;
+    return &((side_t*)posptr)->INTERP_WallPanning;
   case INTERP_FloorPanning:
-    oldipos[i][0] = ((sector_t*)curipos[i].address)->floor_xoffs;
-    oldipos[i][1] = ((sector_t*)curipos[i].address)->floor_yoffs;
-    break;
+    return &((sector_t*)posptr)->INTERP_FloorPanning;
   case INTERP_CeilingPanning:
-    oldipos[i][0] = ((sector_t*)curipos[i].address)->ceiling_xoffs;
-    oldipos[i][1] = ((sector_t*)curipos[i].address)->ceiling_yoffs;
-    break;
+    return &((sector_t*)posptr)->INTERP_CeilingPanning;
+  default:
+    return NULL;
   }
 }
 
-static void R_CopyBakToInterp (int i)
+static void R_InterpolationFields(interpolation_type_e type, void *posptr, fixed_t **field)
 {
-  switch (curipos[i].type)
+  switch (type)
   {
   case INTERP_SectorFloor:
-    ((sector_t*)curipos[i].address)->floorheight = bakipos[i][0];
+    field[0] = &((sector_t*)posptr)->floorheight;
     break;
   case INTERP_SectorCeiling:
-    ((sector_t*)curipos[i].address)->ceilingheight = bakipos[i][0];
-    break;
-  case INTERP_Vertex:
-    ((vertex_t*)curipos[i].address)->x = bakipos[i][0];
-    ((vertex_t*)curipos[i].address)->y = bakipos[i][1];
+    field[0] = &((sector_t*)posptr)->ceilingheight;
     break;
   case INTERP_WallPanning:
-    ((side_t*)curipos[i].address)->rowoffset = bakipos[i][0];
-    ((side_t*)curipos[i].address)->textureoffset = bakipos[i][1];
+    field[0] = &((side_t*)posptr)->rowoffset;
+    field[1] = &((side_t*)posptr)->textureoffset;
     break;
   case INTERP_FloorPanning:
-    ((sector_t*)curipos[i].address)->floor_xoffs = bakipos[i][0];
-    ((sector_t*)curipos[i].address)->floor_yoffs = bakipos[i][1];
+    field[0] = &((sector_t*)posptr)->floor_xoffs;
+    field[1] = &((sector_t*)posptr)->floor_yoffs;
     break;
   case INTERP_CeilingPanning:
-    ((sector_t*)curipos[i].address)->ceiling_xoffs = bakipos[i][0];
-    ((sector_t*)curipos[i].address)->ceiling_yoffs = bakipos[i][1];
+    field[0] = &((sector_t*)posptr)->ceiling_xoffs;
+    field[1] = &((sector_t*)posptr)->ceiling_yoffs;
+    break;
+  default:
     break;
   }
 }
 
-static void R_DoAnInterpolation (int i, fixed_t smoothratio)
+static void R_DoInterpolations(fixed_t smoothratio)
 {
-  fixed_t pos;
-  fixed_t *adr1 = NULL;
-  fixed_t *adr2 = NULL;
-
-  switch (curipos[i].type)
-  {
-  case INTERP_SectorFloor:
-    adr1 = &((sector_t*)curipos[i].address)->floorheight;
-    break;
-  case INTERP_SectorCeiling:
-    adr1 = &((sector_t*)curipos[i].address)->ceilingheight;
-    break;
-  case INTERP_Vertex:
-    adr1 = &((vertex_t*)curipos[i].address)->x;
-////    adr2 = &((vertex_t*)curipos[i].Address)->y;
-    break;
-  case INTERP_WallPanning:
-    adr1 = &((side_t*)curipos[i].address)->rowoffset;
-    adr2 = &((side_t*)curipos[i].address)->textureoffset;
-    break;
-  case INTERP_FloorPanning:
-    adr1 = &((sector_t*)curipos[i].address)->floor_xoffs;
-    adr2 = &((sector_t*)curipos[i].address)->floor_yoffs;
-    break;
-  case INTERP_CeilingPanning:
-    adr1 = &((sector_t*)curipos[i].address)->ceiling_xoffs;
-    adr2 = &((sector_t*)curipos[i].address)->ceiling_yoffs;
-    break;
-
- default:
-    return;
-  }
+  int type, i;
 
-  if (adr1)
+  for (type = 0; type < INTERP_NUMTYPES; type++)
   {
-    pos = bakipos[i][0] = *adr1;
-    *adr1 = oldipos[i][0] + FixedMul (pos - oldipos[i][0], smoothratio);
-  }
+    interp_store_t *st = &interp_stores[type];
+    fixed_t **field = st->field;
+    fixed_t *old = st->old;
+    fixed_t *bak = st->bak;
+    int n = st->num * st->comps;
 
-  if (adr2)
-  {
-    pos = bakipos[i][1] = *adr2;
-    *adr2 = oldipos[i][1] + FixedMul (pos - oldipos[i][1], smoothratio);
+    for (i = 0; i < n; i++)
+    {
+      fixed_t pos = bak[i] = *field[i];
+      *field[i] = old[i] + FixedMul(pos - old[i], smoothratio);
+    }
   }
 
 #ifdef GL_DOOM
-  switch (curipos[i].type)
+  for (type = INTERP_SectorFloor; type <= INTERP_SectorCeiling; type++)
   {
-  case INTERP_SectorFloor:
-  case INTERP_SectorCeiling:
-    gld_UpdateSplitData(((sector_t*)curipos[i].address));
-    break;
+    interp_store_t *st = &interp_stores[type];
+
+    for (i = 0; i < st->num; i++)
+      gld_UpdateSplitData(st->owner[i]);
   }
 #endif
 }
 
 void R_UpdateInterpolations()
 {
-  int i;
+  int type, i;
+
   if (!movement_smooth)
     return;
-  for (i = numinterpolations-1; i >= 0; --i)
-    R_CopyInterpToOld (i);
-}
 
-int interpolations_max = 0;
+  for (type = 0; type < INTERP_NUMTYPES; type++)
+  {
+    interp_store_t *st = &interp_stores[type];
+    int n = st->num * st->comps;
+
+    for (i = 0; i < n; i++)
+      st->old[i] = *st->field[i];
+  }
+}
 
 static void R_SetInterpolation(interpolation_type_e type, void *posptr)
 {
-  int *i;
+  interp_store_t *st = &interp_stores[type];
+  int *i, k;
+
   if (!movement_smooth)
     return;
-  
-  if (numinterpolations >= interpolations_max) {
-    int prevmax = interpolations_max;
 
-    interpolations_max = interpolations_max ? interpolations_max * 2 : 256;
+  i = R_InterpolationIndex(type, posptr);
+  if (i == NULL || (*i) != 0)
+    return;
 
-    if (interpolation_maxobjects > 0 && interpolations_max > interpolation_maxobjects)
-    {
-      interpolations_max = interpolation_maxobjects;
-    }
+  if (interpolation_maxobjects > 0 && numinterpolations >= interpolation_maxobjects)
+    return;
 
-    if (interpolations_max == prevmax)
-    {
-      return;
-    }
-    
-    oldipos = (fixed2_t*)realloc(oldipos, sizeof(*oldipos) * interpolations_max);
-    bakipos = (fixed2_t*)realloc(bakipos, sizeof(*bakipos) * interpolations_max);
-    curipos = (interpolation_t*)realloc(curipos, sizeof(*curipos) * interpolations_max);
-  }
-  
-  i = NULL;
-  switch (type)
+  if (st->num >= st->max)
   {
-  case INTERP_SectorFloor:
-    i = &(((sector_t*)posptr)->INTERP_SectorFloor);
-    break;
-  case INTERP_SectorCeiling:
-    i = &(((sector_t*)posptr)->INTERP_SectorCeiling);
-    break;
-  case INTERP_WallPanning:
-    i = &(((side_t*)posptr)->INTERP_WallPanning);
-    break;
-  case INTERP_FloorPanning:
-    i = &(((sector_t*)posptr)->INTERP_FloorPanning);
-    break;
-  case INTERP_CeilingPanning:
-    i = &(((sector_t*)posptr)->INTERP_CeilingPanning);
-    break;
+    st->max = st->max ? st->max * 2 : 64;
+    st->owner = realloc(st->owner, st->max * sizeof(*st->owner));
+    st->field = realloc(st->field, st->max * st->comps * sizeof(*st->field));
+    st->old = realloc(st->old, st->max * st->comps * sizeof(*st->old));
+    st->bak = realloc(st->bak, st->max * st->comps * sizeof(*st->bak));
   }
 
-  if (i != NULL && (*i) == 0)
-  {
-    curipos[numinterpolations].address = posptr;
-    curipos[numinterpolations].type = type;
-    R_CopyInterpToOld (numinterpolations);
-    numinterpolations++;
-    (*i) = numinterpolations;
-  }
-} 
+  st->owner[st->num] = posptr;
+  R_InterpolationFields(type, posptr, &st->field[st->num * st->comps]);
+  for (k = st->num * st->comps; k < (st->num + 1) * st->comps; k++)
+    st->old[k] = *st->field[k];
+
+  st->num++;
+  numinterpolations++;
+  (*i) = st->num;
+}
 
 static void R_StopInterpolation(interpolation_type_e type, void *posptr)
 {
-  int *i, *j;
-  void *posptr_last;
+  interp_store_t *st = &interp_stores[type];
+  int *i, dst, src, k;
 
   if (!movement_smooth)
     return;
 
-  i = NULL;
-  switch (type)
-  {
-  case INTERP_SectorFloor:
-    i = &(((sector_t*)posptr)->INTERP_SectorFloor);
-    break;
-  case INTERP_SectorCeiling:
-    i = &(((sector_t*)posptr)->INTERP_SectorCeiling);
-    break;
-  case INTERP_WallPanning:
-    i = &(((side_t*)posptr)->INTERP_WallPanning);
-    break;
-  case INTERP_FloorPanning:
-    i = &(((sector_t*)posptr)->INTERP_FloorPanning);
-    break;
-  case INTERP_CeilingPanning:
-    i = &(((sector_t*)posptr)->INTERP_CeilingPanning);
-    break;
-  }
+  i = R_InterpolationIndex(type, posptr);
+  if (i == NULL || (*i) == 0)
+    return;
 
-  if (i != NULL && (*i) != 0)
+  // we have +1 in index field of interpolation's parent;
+  // move the last one into the freed slot
+  st->num--;
+  numinterpolations--;
+  dst = (*i - 1) * st->comps;
+  src = st->num * st->comps;
+  for (k = 0; k < st->comps; k++)
   {
-    numinterpolations--;
-
-    // we have +1 in index field of interpolation's parent
-    oldipos[*i - 1][0] = oldipos[numinterpolations][0];
-    oldipos[*i - 1][1] = oldipos[numinterpolations][1];
-    bakipos[*i - 1][0] = bakipos[numinterpolations][0];
-    bakipos[*i - 1][1] = bakipos[numinterpolations][1];
-    curipos[*i - 1] = curipos[numinterpolations];
-
-    // swap indexes
-    posptr_last = curipos[numinterpolations].address;
-    j = NULL;
-    switch (curipos[numinterpolations].type)
-    {
-    case INTERP_SectorFloor:
-      j = &(((sector_t*)posptr_last)->INTERP_SectorFloor);
-      break;
-    case INTERP_SectorCeiling:
-      j = &(((sector_t*)posptr_last)->INTERP_SectorCeiling);
-      break;
-    case INTERP_WallPanning:
-      j = &(((side_t*)posptr_last)->INTERP_WallPanning);
-      break;
-    case INTERP_FloorPanning:
-      j = &(((sector_t*)posptr_last)->INTERP_FloorPanning);
-      break;
-    case INTERP_CeilingPanning:
-      j = &(((sector_t*)posptr_last)->INTERP_CeilingPanning);
-      break;
-    }
+    st->field[dst + k] = st->field[src + k];
+    st->old[dst + k] = st->old[src + k];
+    st->bak[dst + k] = st->bak[src + k];
+  }
+  st->owner[*i - 1] = st->owner[st->num];
 
-    // swap
-    if (j != NULL)
-    {
-      *j = *i;
-    }
+  // swap indexes
+  *R_InterpolationIndex(type, st->owner[st->num]) = *i;
 
-    // reset
-    *i = 0;
-  }
+  // reset
+  *i = 0;
 }
 
 void R_StopAllInterpolations(void)
@@ -454,15 +460,9 @@ void R_StopAllInterpolations(void)
   if (!movement_smooth)
     return;
 
-  for(i=numinterpolations-1; i>= 0; --i)
-  {
-    numinterpolations--;
-    oldipos[i][0] = oldipos[numinterpolations][0];
-    oldipos[i][1] = oldipos[numinterpolations][1];
-    bakipos[i][0] = bakipos[numinterpolations][0];
-    bakipos[i][1] = bakipos[numinterpolations][1];
-    curipos[i] = curipos[numinterpolations];
-  }
+  for (i = 0; i < INTERP_NUMTYPES; i++)
+    interp_stores[i].num = 0;
+  numinterpolations = 0;
 
   for(i = 0; i < numsectors; i++)
   {
@@ -480,7 +480,7 @@ void R_StopAllInterpolations(void)
 
 void R_RestoreInterpolations(void)
 {
-  int i;
+  int type, i;
   
   if (!movement_smooth)
     return;
@@ -488,9 +488,13 @@ void R_RestoreInterpolations(void)
   if (didInterp)
   {
     didInterp = false;
-    for (i = numinterpolations-1; i >= 0; --i)
+    for (type = 0; type < INTERP_NUMTYPES; type++)
     {
-      R_CopyBakToInterp (i);
+      interp_store_t *st = &interp_stores[type];
+      int n = st->num * st->comps;
+
+      for (i = 0; i < n; i++)
+        *st->field[i] = st->bak[i];
     }
   }
 }
@@ -55,6 +55,25 @@ extern tic_vars_t tic_vars;
 
 void M_ChangeUncappedFrameRate(void);
 
+extern int uncapped_fps_limit;
+
+#define FRAME_HIST_STEP_US 100
+#define FRAME_HIST_SIZE    1000
+
+typedef struct {
+  unsigned int hist[FRAME_HIST_SIZE]; // frame times in FRAME_HIST_STEP_US buckets
+  unsigned int count;
+  unsigned int max_us;
+} frame_stats_t;
+
+extern frame_stats_t frame_stats_window; // reset every second by R_ShowStats
+extern frame_stats_t frame_stats_run;    // reset when a timedemo starts
+
+void R_PaceFrame(void);
+void R_ResetFramePacer(void);
+void R_ResetFrameStats(frame_stats_t *stats);
+unsigned int R_FrameStatsPercentile(const frame_stats_t *stats, int pct);
+
 void R_InitInterpolation(void);
 void R_InterpolateView(player_t *player, fixed_t frac);
 
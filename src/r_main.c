@@ -85,6 +85,10 @@ const lighttable_t *fixedcolormap;
 int      centerx, centery;
 // e6y: wide-res
 int wide_centerx;
+// dynamic resolution: the above at the full view window width, for the
+// vertical projection which is never scaled
+int full_centerx;
+int full_wide_centerx;
 int wide_offsetx;
 int wide_offset2x;
 int wide_offsety;
@@ -334,7 +338,7 @@ static void R_InitTextureMapping (void)
   //  so FIELDOFVIEW angles covers SCREENWIDTH.
 
   focallength = FixedDiv(centerxfrac, finetangent[FINEANGLES/4 + FieldOfView/2]);
-  focallengthy = Scale(centerxfrac, yaspectmul, finetangent[FINEANGLES/4 + FieldOfView/2]);
+  focallengthy = Scale(full_centerx<<FRACBITS, yaspectmul, finetangent[FINEANGLES/4 + FieldOfView/2]);
 
   for (i=0 ; i<FINEANGLES/2 ; i++)
     {
@@ -735,6 +739,60 @@ void R_BuildModelViewMatrix(void)
   m[15] = m[3] * x + m[7] * y + m[11] * z + m[15];
 }
 
+//
+// R_SetupViewColumns
+// Everything that depends on the number of rendered columns. Dynamic
+//  resolution calls it on its own, so a scale step neither redraws the
+//  border nor rebuilds the tables that only depend on the window.
+//
+
+static void R_SetupViewColumns(void)
+{
+  int i;
+
+  // dynamic resolution renders fewer columns, see R_UpdateDynamicResolution
+  viewwidth = scaledviewwidth;
+  if (V_GetMode() != VID_MODEGL && render_dynres_scale < 100)
+    viewwidth = MAX(scaledviewwidth * render_dynres_scale / 100, 2);
+
+  centerx = viewwidth/2;
+  centerxfrac = centerx<<FRACBITS;
+
+  if (tallscreen)
+    wide_centerx = centerx;
+  else
+    wide_centerx = centerx * ratio_multiplier / ratio_scale;
+
+  // e6y: wide-res
+  projection = wide_centerx<<FRACBITS;
+
+  // e6y: this is a precalculated value for more precise flats drawing (see R_MapPlane)
+  viewfocratio = projectiony / wide_centerx;
+
+  R_InitTextureMapping();
+  R_InitViewStretch();
+
+  // psprite scales
+  // proff 08/17/98: Changed for high-res
+  // proff 11/06/98: Added for high-res
+  // e6y: wide-res
+  pspritexscale = (wide_centerx << FRACBITS) / 160;
+  pspriteiscale = FixedDiv (FRACUNIT, pspritexscale);
+
+  //e6y: added for GL
+  pspritexscale_f = (float)wide_centerx/160.0f;
+
+  // thing clipping
+  for (i=0 ; i<viewwidth ; i++)
+    screenheightarray[i] = viewheight;
+
+  for (i=0 ; i<viewwidth ; i++)
+    {
+      fixed_t cosadj = D_abs(finecosine[xtoviewangle[i]>>ANGLETOFINESHIFT]);
+      distscale[i] = FixedDiv(FRACUNIT,cosadj);
+    }
+}
+
 //
 // R_ExecuteSetViewSize
 //
@@ -769,48 +827,34 @@ void R_ExecuteSetViewSize (void)
       freelookviewheight = setblocks*SCREENHEIGHT/10;
     }
 
-  viewwidth = scaledviewwidth;
-
   viewheightfrac = viewheight<<FRACBITS;//e6y
 
   centery = viewheight/2;
-  centerx = viewwidth/2;
-  centerxfrac = centerx<<FRACBITS;
+  full_centerx = scaledviewwidth/2;
   centeryfrac = centery<<FRACBITS;
 
   if (tallscreen)
   {
-    wide_centerx = centerx;
+    full_wide_centerx = full_centerx;
     cheight = SCREENHEIGHT * ratio_multiplier / ratio_scale;
   }
   else
   {
-    wide_centerx = centerx * ratio_multiplier / ratio_scale;
+    full_wide_centerx = full_centerx * ratio_multiplier / ratio_scale;
     cheight = SCREENHEIGHT;
   }
 
-  // e6y: wide-res
-  projection = wide_centerx<<FRACBITS;
-
 // proff 11/06/98: Added for high-res
   // calculate projectiony using int_64_t math to avoid overflow when SCREENWIDTH>4228
-  projectiony = (fixed_t)((((int_64_t)cheight * centerx * 320) / 200) / SCREENWIDTH * FRACUNIT);
-  // e6y: this is a precalculated value for more precise flats drawing (see R_MapPlane)
-  viewfocratio = projectiony / wide_centerx;
+  projectiony = (fixed_t)((((int_64_t)cheight * full_centerx * 320) / 200) / SCREENWIDTH * FRACUNIT);
 
   R_SetupViewScaling();
 
   R_InitBuffer (scaledviewwidth, viewheight);
 
-  R_InitTextureMapping();
+  R_SetupViewColumns();
 
-  // psprite scales
-  // proff 08/17/98: Changed for high-res
-  // proff 11/06/98: Added for high-res
-  // e6y: wide-res
-  pspritexscale = (wide_centerx << FRACBITS) / 160;
-  pspriteyscale = (((cheight*viewwidth)/SCREENWIDTH) << FRACBITS) / 200;
-  pspriteiscale = FixedDiv (FRACUNIT, pspritexscale);
+  pspriteyscale = (((cheight*scaledviewwidth)/SCREENWIDTH) << FRACBITS) / 200;
   // [FG] make sure that the product of the weapon sprite scale factor
   //      and its reciprocal is always at least FRACUNIT to
   //      fix garbage lines at the top of weapon sprites
@@ -818,25 +862,13 @@ void R_ExecuteSetViewSize (void)
   while (FixedMul(pspriteiyscale, pspriteyscale) < FRACUNIT)
     pspriteiyscale++;
 
-  //e6y: added for GL
-  pspritexscale_f = (float)wide_centerx/160.0f;
-  pspriteyscale_f = (((float)cheight*viewwidth)/(float)SCREENWIDTH) / 200.0f;
+  pspriteyscale_f = (((float)cheight*scaledviewwidth)/(float)SCREENWIDTH) / 200.0f;
 
-  skyiscale = (fixed_t)(((uint_64_t)FRACUNIT * SCREENWIDTH * 200) / (viewwidth * SCREENHEIGHT));
+  skyiscale = (fixed_t)(((uint_64_t)FRACUNIT * SCREENWIDTH * 200) / (scaledviewwidth * SCREENHEIGHT));
 
 	// [RH] Sky height fix for screens not 200 (or 240) pixels tall
 	R_InitSkyMap();
 
-  // thing clipping
-  for (i=0 ; i<viewwidth ; i++)
-    screenheightarray[i] = viewheight;
-
-  for (i=0 ; i<viewwidth ; i++)
-    {
-      fixed_t cosadj = D_abs(finecosine[xtoviewangle[i]>>ANGLETOFINESHIFT]);
-      distscale[i] = FixedDiv(FRACUNIT,cosadj);
-    }
-
   // e6y
   // Calculate the light levels to use
   //  for each level / scale combination.
@@ -930,7 +962,7 @@ void R_SetupFreelook(void)
     }
     centeryfrac = centery<<FRACBITS;
     
-    InvZtoScale = yaspectmul * centerx;
+    InvZtoScale = yaspectmul * full_centerx;
     globaluclip = FixedDiv (-centeryfrac, InvZtoScale);
     globaldclip = FixedDiv ((viewheight<<FRACBITS)-centeryfrac, InvZtoScale);
 
@@ -1048,11 +1080,13 @@ static void R_SetupFrame (player_t *player)
 //
 int rendered_visplanes, rendered_segs, rendered_vissprites;
 dboolean rendering_stats;
+dboolean cache_stats;
 int renderer_fps = 0;
 
 void R_ShowStats(void)
 {
   static unsigned int FPS_SavedTick = 0, FPS_FrameCount = 0;
+  static zone_cachestats_t saved_cachestats;
   unsigned int tick = I_GetTime_MS();
   FPS_FrameCount++;
   if(tick >= FPS_SavedTick + 1000)
@@ -1060,11 +1094,36 @@ void R_ShowStats(void)
     renderer_fps = 1000 * FPS_FrameCount / (tick - FPS_SavedTick);
     if (rendering_stats)
     {
-      doom_printf((V_GetMode() == VID_MODEGL)
-                  ?"Frame rate %d fps\nWalls %d, Flats %d, Sprites %d"
-                  :"Frame rate %d fps\nSegs %d, Visplanes %d, Sprites %d",
-      renderer_fps, rendered_segs, rendered_visplanes, rendered_vissprites);
+      double p50 = R_FrameStatsPercentile(&frame_stats_window, 50) / 1000.0;
+      double p99 = R_FrameStatsPercentile(&frame_stats_window, 99) / 1000.0;
+      double fmax = frame_stats_window.max_us / 1000.0;
+
+      if (V_GetMode() == VID_MODEGL)
+        doom_printf("Frame rate %d fps, %.1f/%.1f/%.1f ms\nWalls %d, Flats %d, Sprites %d",
+          renderer_fps, p50, p99, fmax,
+          rendered_segs, rendered_visplanes, rendered_vissprites);
+      else
+        doom_printf("Frame rate %d fps, %.1f/%.1f/%.1f ms\nSegs %d, Visplanes %d, Sprites %d\nPresent %uK/frame",
+          renderer_fps, p50, p99, fmax,
+          rendered_segs, rendered_visplanes, rendered_vissprites,
+          v_presented_bytes / FPS_FrameCount / 1024);
+    }
+    else if (cache_stats)
+    {
+      // per-second deltas, so churn shows up as it happens
+      unsigned int hits = zone_cachestats.hits - saved_cachestats.hits;
+      unsigned int misses = zone_cachestats.misses - saved_cachestats.misses;
+
+      doom_printf("Cache %luK/%dK, hits %u, misses %u\nEvicted %u (%luK), total %u",
+        (unsigned long)(zone_cachestats.cached_bytes / 1024), cache_memory_budget,
+        hits, misses,
+        zone_cachestats.evictions - saved_cachestats.evictions,
+        (unsigned long)((zone_cachestats.evicted_bytes - saved_cachestats.evicted_bytes) / 1024),
+        zone_cachestats.evictions);
     }
+    saved_cachestats = zone_cachestats;
+    R_ResetFrameStats(&frame_stats_window);
+    v_presented_bytes = 0;
     FPS_SavedTick = tick;
     FPS_FrameCount = 0;
   }
@@ -1077,12 +1136,68 @@ void R_ClearStats(void)
   rendered_vissprites = 0;
 }
 
+//
+// Dynamic resolution
+//
+// The software renderer's cost is mostly per column, so when the view takes
+// longer than render_dynres_target ms to render, fewer columns are rendered
+// and R_StretchViewWindow widens them back to the view window. The width is
+// reevaluated every DYNRES_FRAMES frames: it drops in proportion to the
+// overshoot and recovers in small steps once there is headroom, which keeps
+// it from oscillating around the target.
+//
+
+#define DYNRES_FRAMES 8
+#define DYNRES_STEP 5
+
+int render_dynres;
+int render_dynres_min = 50;    // percent of the view window width
+int render_dynres_target = 16; // ms per R_RenderPlayerView
+int render_dynres_scale = 100;
+
+static void R_UpdateDynamicResolution(unsigned int rendertime)
+{
+  static unsigned int total_time, frames;
+  int scale = render_dynres_scale;
+
+  if (!render_dynres)
+  {
+    scale = 100;
+    total_time = frames = 0;
+  }
+  else
+  {
+    unsigned int target = render_dynres_target * DYNRES_FRAMES;
+
+    total_time += rendertime;
+    if (++frames < DYNRES_FRAMES)
+      return;
+
+    if (total_time > target)
+      scale = MIN((int)(scale * target / total_time), scale - DYNRES_STEP);
+    else if (total_time < target * 3 / 4)
+      scale += DYNRES_STEP;
+
+    scale = BETWEEN(render_dynres_min, 100, scale / DYNRES_STEP * DYNRES_STEP);
+    total_time = frames = 0;
+  }
+
+  // only the rendered columns change, the view window stays put
+  if (scale != render_dynres_scale)
+  {
+    render_dynres_scale = scale;
+    if (!setsizeneeded)
+      R_SetupViewColumns();
+  }
+}
+
 //
 // R_RenderView
 //
 void R_RenderPlayerView (player_t* player)
 {
   dboolean automap = (automapmode & am_active) && !(automapmode & am_overlay);
+  unsigned int starttime = I_GetTime_MS();
 
   r_frame_count++;
 
@@ -1151,6 +1266,11 @@ void R_RenderPlayerView (player_t* player)
   if (V_GetMode() != VID_MODEGL) {
     R_DrawMasked ();
     R_ResetColumnBuffer();
+
+    R_StretchViewWindow();
+    R_UpdateDynamicResolution(I_GetTime_MS() - starttime);
+
+    V_MarkRect(viewwindowx, viewwindowy, scaledviewwidth, viewheight);
   }
 
   // Check for new console commands.
@@ -67,6 +67,8 @@ extern fixed_t  projection;
 extern fixed_t  skyiscale;
 // e6y: wide-res
 extern int wide_centerx;
+extern int full_centerx;
+extern int full_wide_centerx;
 extern int wide_offsetx;
 extern int wide_offset2x;
 extern int wide_offsety;
@@ -85,6 +87,16 @@ extern fixed_t viewfocratio;
 
 extern int rendered_visplanes, rendered_segs, rendered_vissprites;
 extern dboolean rendering_stats;
+extern dboolean cache_stats;
+
+//
+// Dynamic resolution
+//
+
+extern int render_dynres;
+extern int render_dynres_min;
+extern int render_dynres_target;
+extern int render_dynres_scale;
 
 //
 // Lighting LUT.
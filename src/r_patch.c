@@ -883,7 +883,12 @@ const rpatch_t *R_CachePatchNum(int id) {
 #endif
 
   if (!patches[id].data)
+  {
+    zone_cachestats.misses++;
     createPatch(id);
+  }
+  else
+    zone_cachestats.hits++;
 
   /* cph - if wasn't locked but now is, tell z_zone to hold it */
   if (!patches[id].locks && locks) {
@@ -932,7 +937,12 @@ const rpatch_t *R_CacheTextureCompositePatchNum(int id) {
 #endif
 
   if (!texture_composites[id].data)
+  {
+    zone_cachestats.misses++;
     createTextureCompositePatch(id);
+  }
+  else
+    zone_cachestats.hits++;
 
   /* cph - if wasn't locked but now is, tell z_zone to hold it */
   if (!texture_composites[id].locks && locks) {
@@ -334,7 +334,7 @@ void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
 
         if (!fixedcolormap)
         {
-          int index = (int)(((int_64_t)spryscale * 160 / wide_centerx) >> LIGHTSCALESHIFT);
+          int index = (int)(((int_64_t)spryscale * 160 / full_wide_centerx) >> LIGHTSCALESHIFT);
           if (index >= MAXLIGHTSCALE)
             index = MAXLIGHTSCALE - 1;
 
@@ -398,6 +398,85 @@ void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
   curline = NULL; /* cph 2001/11/18 - must clear curline now we're done with it, so R_ColourMap doesn't try using it for other things */
 }
 
+//
+// Per column wall state of the seg being rendered, filled by the first
+// pass of R_RenderSegLoop and read by R_DrawWallTier.
+//
+
+static int      *wall_yl, *wall_yh;     // clipped wall span
+static int      *wall_top;              // last row of the upper tier
+static int      *wall_bottom;           // first row of the lower tier
+static int      *wall_texcol;           // texture column
+static fixed_t  *wall_texu;             // unshifted texture column, for filtering
+static fixed_t  *wall_scale;
+static int      *wall_light;            // walllights index
+
+void R_InitSegsRes(void)
+{
+  if (wall_yl) free(wall_yl);
+
+  // one block, the arrays are only used together
+  wall_yl = calloc(1, 8 * SCREENWIDTH * sizeof(*wall_yl));
+  wall_yh = wall_yl + SCREENWIDTH;
+  wall_top = wall_yh + SCREENWIDTH;
+  wall_bottom = wall_top + SCREENWIDTH;
+  wall_texcol = wall_bottom + SCREENWIDTH;
+  wall_texu = wall_texcol + SCREENWIDTH;
+  wall_scale = wall_texu + SCREENWIDTH;
+  wall_light = wall_scale + SCREENWIDTH;
+}
+
+//
+// R_DrawWallTier
+//
+// Draws one wall tier of texture over the columns x1 to x2-1, from
+// top[x] down to bottom[x].
+//
+
+static void R_DrawWallTier(int x1, int x2, int texture, int texheight,
+                           fixed_t texturemid, const int *top, const int *bottom)
+{
+  const rpatch_t *tex_patch = R_CacheTextureCompositePatchNum(texture);
+  R_DrawColumn_f colfunc = R_GetDrawColumnFunc(RDC_PIPELINE_STANDARD, drawvars.filterwall, drawvars.filterz);
+  draw_column_vars_t dcvars;
+  int x;
+
+  R_SetDefaultDrawColumnVars(&dcvars);
+
+  dcvars.texturemid = texturemid;
+  dcvars.texheight = texheight;
+
+  if (fixedcolormap)
+  {
+    dcvars.colormap = fixedcolormap;
+    dcvars.nextcolormap = fixedcolormap;
+  }
+
+  for (x = x1; x < x2; x++)
+  {
+    if (top[x] > bottom[x])
+      continue;
+
+    dcvars.x = x;
+    dcvars.yl = top[x];
+    dcvars.yh = bottom[x];
+    dcvars.texu = wall_texu[x];
+    dcvars.z = wall_scale[x];
+    dcvars.iscale = 0xffffffffu / (unsigned)wall_scale[x];
+    if (!fixedcolormap)
+    {
+      dcvars.colormap = walllights[wall_light[x]];
+      dcvars.nextcolormap = walllightsnext[wall_light[x]];
+    }
+    dcvars.source = R_GetTextureColumn(tex_patch, wall_texcol[x]);
+    dcvars.prevsource = R_GetTextureColumn(tex_patch, wall_texcol[x]-1);
+    dcvars.nextsource = R_GetTextureColumn(tex_patch, wall_texcol[x]+1);
+    colfunc(&dcvars);
+  }
+
+  R_UnlockTextureCompositePatchNum(texture);
+}
+
 //
 // R_RenderSegLoop
 // Draws zero, one, or two textures (and possibly a masked texture) for walls.
@@ -409,14 +488,13 @@ static int didsolidcol; /* True if at least one column was marked solid */
 
 static void R_RenderSegLoop (void)
 {
-  const rpatch_t *tex_patch;
-  R_DrawColumn_f colfunc = R_GetDrawColumnFunc(RDC_PIPELINE_STANDARD, drawvars.filterwall, drawvars.filterz);
-  draw_column_vars_t dcvars;
   fixed_t  texturecolumn = 0;   // shut up compiler warning
-
-  R_SetDefaultDrawColumnVars(&dcvars);
+  int      start = rw_x;
 
   rendered_segs++;
+
+  // First pass: clip every column, mark the visplanes and record the
+  // wall tier spans, texture coordinates and light in the column arrays.
   for ( ; rw_x < rw_stopx ; rw_x++)
     {
 
@@ -467,6 +545,9 @@ static void R_RenderSegLoop (void)
           floorclip[rw_x] = top;
         }
 
+      wall_yl[rw_x] = yl;
+      wall_yh[rw_x] = yh;
+
       // texturecolumn and lighting are independent of wall tiers
       if (segtextured)
         {
@@ -476,45 +557,24 @@ static void R_RenderSegLoop (void)
           texturecolumn = rw_offset-FixedMul(finetangent[angle],rw_distance);
           if (drawvars.filterwall == RDRAW_FILTER_LINEAR)
             texturecolumn -= (FRACUNIT>>1);
-          dcvars.texu = texturecolumn; // for filtering -- POPE
+          wall_texu[rw_x] = texturecolumn; // for filtering -- POPE
           texturecolumn >>= FRACBITS;
 
           // calculate lighting
           if (!fixedcolormap)
           {
-            int index = (int)(((int_64_t)rw_scale * 160 / wide_centerx) >> LIGHTSCALESHIFT);
+            int index = (int)(((int_64_t)rw_scale * 160 / full_wide_centerx) >> LIGHTSCALESHIFT);
             if (index >= MAXLIGHTSCALE)
                index = MAXLIGHTSCALE - 1;
 
-            dcvars.colormap = walllights[index];
-            dcvars.nextcolormap = walllightsnext[index];
-          }
-          else
-          {
-            dcvars.colormap = fixedcolormap;
-            dcvars.nextcolormap = fixedcolormap;
+            wall_light[rw_x] = index;
           }
-          dcvars.z = rw_scale; // for filtering -- POPE
-
-          dcvars.x = rw_x;
-          dcvars.iscale = 0xffffffffu / (unsigned)rw_scale;
+          wall_scale[rw_x] = rw_scale;
         }
 
-      // draw the wall tiers
+      // clip the wall tiers
       if (midtexture)
         {
-
-          dcvars.yl = yl;     // single sided line
-          dcvars.yh = yh;
-          dcvars.texturemid = rw_midtexturemid;
-          tex_patch = R_CacheTextureCompositePatchNum(midtexture);
-          dcvars.source = R_GetTextureColumn(tex_patch, texturecolumn);
-          dcvars.prevsource = R_GetTextureColumn(tex_patch, texturecolumn-1);
-          dcvars.nextsource = R_GetTextureColumn(tex_patch, texturecolumn+1);
-          dcvars.texheight = midtexheight;
-          colfunc(&dcvars);
-          R_UnlockTextureCompositePatchNum(midtexture);
-          tex_patch = NULL;
           ceilingclip[rw_x] = viewheight;
           floorclip[rw_x] = -1;
         }
@@ -524,28 +584,16 @@ static void R_RenderSegLoop (void)
           // two sided line
           if (toptexture)
             {
-              // top wall
+              // top wall, drawn from yl down to mid when mid >= yl
               int mid = (int)(pixhigh>>HEIGHTBITS);
               pixhigh += pixhighstep;
 
               if (mid >= floorclip[rw_x])
                 mid = floorclip[rw_x]-1;
 
+              wall_top[rw_x] = mid;
               if (mid >= yl)
-                {
-                  dcvars.yl = yl;
-                  dcvars.yh = mid;
-                  dcvars.texturemid = rw_toptexturemid;
-                  tex_patch = R_CacheTextureCompositePatchNum(toptexture);
-                  dcvars.source = R_GetTextureColumn(tex_patch,texturecolumn);
-                  dcvars.prevsource = R_GetTextureColumn(tex_patch,texturecolumn-1);
-                  dcvars.nextsource = R_GetTextureColumn(tex_patch,texturecolumn+1);
-                  dcvars.texheight = toptexheight;
-                  colfunc(&dcvars);
-                  R_UnlockTextureCompositePatchNum(toptexture);
-                  tex_patch = NULL;
-                  ceilingclip[rw_x] = mid;
-                }
+                ceilingclip[rw_x] = mid;
               else
                 ceilingclip[rw_x] = yl-1;
             }
@@ -558,6 +606,7 @@ static void R_RenderSegLoop (void)
 
           if (bottomtexture)          // bottom wall
             {
+              // drawn from mid down to yh when mid <= yh
               int mid = (int)((pixlow+HEIGHTUNIT-1)>>HEIGHTBITS);
               pixlow += pixlowstep;
 
@@ -565,21 +614,9 @@ static void R_RenderSegLoop (void)
               if (mid <= ceilingclip[rw_x])
                 mid = ceilingclip[rw_x]+1;
 
+              wall_bottom[rw_x] = mid;
               if (mid <= yh)
-                {
-                  dcvars.yl = mid;
-                  dcvars.yh = yh;
-                  dcvars.texturemid = rw_bottomtexturemid;
-                  tex_patch = R_CacheTextureCompositePatchNum(bottomtexture);
-                  dcvars.source = R_GetTextureColumn(tex_patch, texturecolumn);
-                  dcvars.prevsource = R_GetTextureColumn(tex_patch, texturecolumn-1);
-                  dcvars.nextsource = R_GetTextureColumn(tex_patch, texturecolumn+1);
-                  dcvars.texheight = bottomtexheight;
-                  colfunc(&dcvars);
-                  R_UnlockTextureCompositePatchNum(bottomtexture);
-                  tex_patch = NULL;
-                  floorclip[rw_x] = mid;
-                }
+                floorclip[rw_x] = mid;
               else
                 floorclip[rw_x] = yh+1;
             }
@@ -601,10 +638,27 @@ static void R_RenderSegLoop (void)
             maskedtexturecol[rw_x] = texturecolumn;
         }
 
+      wall_texcol[rw_x] = texturecolumn;
+
       rw_scale += rw_scalestep;
       topfrac += topstep;
       bottomfrac += bottomstep;
     }
+
+  // Second pass: draw each tier across the whole range, so its texture
+  // is looked up once and the column drawer runs back to back.
+  if (midtexture)
+    R_DrawWallTier(start, rw_stopx, midtexture, midtexheight,
+                   rw_midtexturemid, wall_yl, wall_yh);
+  else
+    {
+      if (toptexture)
+        R_DrawWallTier(start, rw_stopx, toptexture, toptexheight,
+                       rw_toptexturemid, wall_yl, wall_top);
+      if (bottomtexture)
+        R_DrawWallTier(start, rw_stopx, bottomtexture, bottomtexheight,
+                       rw_bottomtexturemid, wall_bottom, wall_yh);
+    }
 }
 
 // killough 5/2/98: move from r_main.c, made static, simplified
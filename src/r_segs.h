@@ -40,5 +40,6 @@
 
 void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2);
 void R_StoreWallRange(const int start, const int stop);
+void R_InitSegsRes(void);
 
 #endif
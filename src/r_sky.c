@@ -62,9 +62,9 @@ void R_InitSkyMap(void)
   {
     skystretch = false;
     skytexturemid = 100*FRACUNIT;
-    if (viewwidth != 0)
+    if (scaledviewwidth != 0)
     {
-      skyiscale = (fixed_t)(((uint_64_t)FRACUNIT * SCREENWIDTH * 200) / (viewwidth * SCREENHEIGHT));
+      skyiscale = (fixed_t)(((uint_64_t)FRACUNIT * SCREENWIDTH * 200) / (scaledviewwidth * SCREENHEIGHT));
     }
   }
   else
@@ -101,10 +101,10 @@ void R_InitSkyMap(void)
       skytexturemid = (200 - skyheight) << FRACBITS;
     }
 
-    if (viewwidth != 0 && viewheight != 0)
+    if (scaledviewwidth != 0 && viewheight != 0)
     {
       //skyiscale = 200 * FRACUNIT / freelookviewheight;
-      skyiscale = (fixed_t)(((uint_64_t)FRACUNIT * SCREENWIDTH * 200) / (viewwidth * SCREENHEIGHT));
+      skyiscale = (fixed_t)(((uint_64_t)FRACUNIT * SCREENWIDTH * 200) / (scaledviewwidth * SCREENHEIGHT));
       // line below is from zdoom, but it works incorrectly with prboom
       // with widescreen resolutions (eg 1280x720) by some reasons
       //skyiscale = (fixed_t)((int_64_t)skyiscale * FieldOfView / 2048);
@@ -83,19 +83,25 @@ typedef struct drawseg_xrange_item_s
   drawseg_t *user;
 } drawseg_xrange_item_t;
 
-typedef struct drawsegs_xrange_s
-{
-  drawseg_xrange_item_t *items;
-  int count;
-} drawsegs_xrange_t;
-
-#define DS_RANGES_COUNT 3
-static drawsegs_xrange_t drawsegs_xranges[DS_RANGES_COUNT];
+// Drawsegs that can clip sprites, back to front, binned by screen column.
+// Level 0 bins are 1<<DS_BIN_SHIFT columns wide and every next level doubles
+// the width, up to a single bin for the whole view. Each bin lists the
+// indices of the drawsegs it overlaps in ascending order, so any sprite can
+// be served by merging at most two bins of one level.
+#define DS_BIN_SHIFT 5
+#define DS_BIN_LEVELS 16
 
 static drawseg_xrange_item_t *drawsegs_xrange;
 static unsigned int drawsegs_xrange_size = 0;
 static int drawsegs_xrange_count = 0;
 
+static int drawsegs_bin_levels;
+static int drawsegs_bin_base[DS_BIN_LEVELS + 1]; // first bin of each level
+static int *drawsegs_bin_start;                  // item offsets, per bin + 1
+static int drawsegs_bin_start_size;
+static int *drawsegs_bin_items;
+static int drawsegs_bin_items_size;
+
 // constant arrays
 //  used for psprite clipping and initializing clipping
 
@@ -1224,6 +1230,78 @@ void R_SortVisSprites (void)
     }
 }
 
+//
+// R_BinDrawsegs
+//
+// Fills the column bins of every level from drawsegs_xrange.
+//
+
+static void R_BinDrawsegs(void)
+{
+  int level, shift, bins, total, i, x1, x2, b;
+
+  drawsegs_bin_levels = 0;
+  bins = 0;
+  shift = DS_BIN_SHIFT;
+  do
+  {
+    drawsegs_bin_base[drawsegs_bin_levels++] = bins;
+    bins += ((viewwidth - 1) >> shift) + 1;
+  } while (((viewwidth - 1) >> shift++) > 0 && drawsegs_bin_levels < DS_BIN_LEVELS);
+  drawsegs_bin_base[drawsegs_bin_levels] = bins;
+
+  if (drawsegs_bin_start_size < bins + 1)
+  {
+    drawsegs_bin_start_size = bins + 1;
+    drawsegs_bin_start = realloc(drawsegs_bin_start,
+      drawsegs_bin_start_size * sizeof(drawsegs_bin_start[0]));
+  }
+  memset(drawsegs_bin_start, 0, (bins + 1) * sizeof(drawsegs_bin_start[0]));
+
+  // count, then turn the counts into offsets, then fill in seg order
+  for (i = 0; i < drawsegs_xrange_count; i++)
+  {
+    for (level = 0, shift = DS_BIN_SHIFT; level < drawsegs_bin_levels; level++, shift++)
+    {
+      int last = drawsegs_bin_base[level + 1] - drawsegs_bin_base[level] - 1;
+
+      x1 = MIN(MAX(drawsegs_xrange[i].x1, 0) >> shift, last);
+      x2 = MIN(MAX(drawsegs_xrange[i].x2, 0) >> shift, last);
+      for (b = x1; b <= x2; b++)
+        drawsegs_bin_start[drawsegs_bin_base[level] + b + 1]++;
+    }
+  }
+
+  for (b = 0; b < bins; b++)
+    drawsegs_bin_start[b + 1] += drawsegs_bin_start[b];
+  total = drawsegs_bin_start[bins];
+
+  if (drawsegs_bin_items_size < total)
+  {
+    drawsegs_bin_items_size = total * 2;
+    drawsegs_bin_items = realloc(drawsegs_bin_items,
+      drawsegs_bin_items_size * sizeof(drawsegs_bin_items[0]));
+  }
+
+  for (i = 0; i < drawsegs_xrange_count; i++)
+  {
+    for (level = 0, shift = DS_BIN_SHIFT; level < drawsegs_bin_levels; level++, shift++)
+    {
+      int last = drawsegs_bin_base[level + 1] - drawsegs_bin_base[level] - 1;
+
+      x1 = MIN(MAX(drawsegs_xrange[i].x1, 0) >> shift, last);
+      x2 = MIN(MAX(drawsegs_xrange[i].x2, 0) >> shift, last);
+      for (b = drawsegs_bin_base[level] + x1; b <= drawsegs_bin_base[level] + x2; b++)
+        drawsegs_bin_items[drawsegs_bin_start[b]++] = i;
+    }
+  }
+
+  // the fill advanced every offset to the start of the next bin
+  for (b = bins; b > 0; b--)
+    drawsegs_bin_start[b] = drawsegs_bin_start[b - 1];
+  drawsegs_bin_start[0] = 0;
+}
+
 //
 // R_DrawSprite
 //
@@ -1250,12 +1328,51 @@ static void R_DrawSprite (vissprite_t* spr)
   // and buggy, by going past LEFT end of array):
 
   // e6y: optimization
-  if (drawsegs_xrange_size)
+  if (drawsegs_xrange_count)
   {
-    const drawseg_xrange_item_t *last = &drawsegs_xrange[drawsegs_xrange_count - 1];
-    drawseg_xrange_item_t *curr = &drawsegs_xrange[-1];
-    while (++curr <= last)
+    const int *a, *a_end, *b, *b_end;
+    int shift = DS_BIN_SHIFT;
+    int level = 0;
+    int b1, b2;
+
+    // the finest level where the sprite spans at most two bins
+    while ((spr->x2 >> shift) - (spr->x1 >> shift) > 1 && level < drawsegs_bin_levels - 1)
     {
+      shift++;
+      level++;
+    }
+    b1 = drawsegs_bin_base[level] + (spr->x1 >> shift);
+    b2 = drawsegs_bin_base[level] + (spr->x2 >> shift);
+    b1 = MIN(b1, drawsegs_bin_base[level + 1] - 1);
+    b2 = MIN(b2, drawsegs_bin_base[level + 1] - 1);
+
+    a = drawsegs_bin_items + drawsegs_bin_start[b1];
+    a_end = drawsegs_bin_items + drawsegs_bin_start[b1 + 1];
+    if (b2 != b1)
+    {
+      b = drawsegs_bin_items + drawsegs_bin_start[b2];
+      b_end = drawsegs_bin_items + drawsegs_bin_start[b2 + 1];
+    }
+    else
+    {
+      b = b_end = a_end;
+    }
+
+    while (a < a_end || b < b_end)
+    {
+      const drawseg_xrange_item_t *curr;
+
+      // merge both bins back to front, a seg in both is visited once
+      if (b == b_end || (a < a_end && *a < *b))
+        curr = &drawsegs_xrange[*a++];
+      else if (a == a_end || *b < *a)
+        curr = &drawsegs_xrange[*b++];
+      else
+      {
+        curr = &drawsegs_xrange[*a++];
+        b++;
+      }
+
       // determine if the drawseg obscures the sprite
       if (curr->x1 > spr->x2 || curr->x2 < spr->x1)
         continue;      // does not cover sprite
@@ -1370,7 +1487,6 @@ void R_DrawMasked(void)
 {
   int i;
   drawseg_t *ds;
-  int cx = SCREENWIDTH / 2;
 
   R_SortVisSprites();
 
@@ -1378,73 +1494,36 @@ void R_DrawMasked(void)
   // Reducing of cache misses in the following R_DrawSprite()
   // Makes sense for scenes with huge amount of drawsegs.
   // ~12% of speed improvement on epic.wad map05
-  for(i = 0; i < DS_RANGES_COUNT; i++)
-    drawsegs_xranges[i].count = 0;
+  drawsegs_xrange_count = 0;
 
   if (num_vissprite > 0)
   {
     if (drawsegs_xrange_size < maxdrawsegs)
     {
       drawsegs_xrange_size = 2 * maxdrawsegs;
-      for(i = 0; i < DS_RANGES_COUNT; i++)
-      {
-        drawsegs_xranges[i].items = realloc(
-          drawsegs_xranges[i].items,
-          drawsegs_xrange_size * sizeof(drawsegs_xranges[i].items[0]));
-      }
+      drawsegs_xrange = realloc(drawsegs_xrange,
+        drawsegs_xrange_size * sizeof(drawsegs_xrange[0]));
     }
     for (ds = ds_p; ds-- > drawsegs;)
     {
       if (ds->silhouette || ds->maskedtexturecol)
       {
-        drawsegs_xranges[0].items[drawsegs_xranges[0].count].x1 = ds->x1;
-        drawsegs_xranges[0].items[drawsegs_xranges[0].count].x2 = ds->x2;
-        drawsegs_xranges[0].items[drawsegs_xranges[0].count].user = ds;
-        
-        // e6y: ~13% of speed improvement on sunder.wad map10
-        if (ds->x1 < cx)
-        {
-          drawsegs_xranges[1].items[drawsegs_xranges[1].count] = 
-            drawsegs_xranges[0].items[drawsegs_xranges[0].count];
-          drawsegs_xranges[1].count++;
-        }
-        if (ds->x2 >= cx)
-        {
-          drawsegs_xranges[2].items[drawsegs_xranges[2].count] = 
-            drawsegs_xranges[0].items[drawsegs_xranges[0].count];
-          drawsegs_xranges[2].count++;
-        }
-
-        drawsegs_xranges[0].count++;
+        drawsegs_xrange[drawsegs_xrange_count].x1 = ds->x1;
+        drawsegs_xrange[drawsegs_xrange_count].x2 = ds->x2;
+        drawsegs_xrange[drawsegs_xrange_count].user = ds;
+        drawsegs_xrange_count++;
       }
     }
+
+    if (drawsegs_xrange_count)
+      R_BinDrawsegs();
   }
 
   // draw all vissprites back to front
 
   rendered_vissprites = num_vissprite;
   for (i = num_vissprite ;--i>=0; )
-  {
-    vissprite_t* spr = vissprite_ptrs[i];
-
-    if (spr->x2 < cx)
-    {
-      drawsegs_xrange = drawsegs_xranges[1].items;
-      drawsegs_xrange_count = drawsegs_xranges[1].count;
-    }
-    else if (spr->x1 >= cx)
-    {
-      drawsegs_xrange = drawsegs_xranges[2].items;
-      drawsegs_xrange_count = drawsegs_xranges[2].count;
-    }
-    else
-    {
-      drawsegs_xrange = drawsegs_xranges[0].items;
-      drawsegs_xrange_count = drawsegs_xranges[0].count;
-    }
-
     R_DrawSprite(vissprite_ptrs[i]);
-  }
 
   // render any remaining masked mid textures
 
@@ -0,0 +1,134 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *  Present kernels for rotated framebuffers.
+ *
+ *  Writing a rotated framebuffer pixel by pixel in screen order stores
+ *  with a stride of a whole column, so every store touches a different
+ *  cache line. These kernels work on 8x8 blocks instead: the eight
+ *  source rows of a block stay cached while each output column is
+ *  written as a contiguous run, with the format conversion done between
+ *  the load and the store. 16 bit pixels are stored in pairs.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stddef.h>
+
+#include "doomtype.h"
+#include "v_present.h"
+
+#define ROTATE_BLOCK 8
+
+#define ARGB1555_2_RGBA5551(x) ((unsigned short)(((x) << 1) | (((x) & 0x8000) >> 15)))
+#define RGB565_2_RGB565(x)     (x)
+#define ARGB8_2_RGBA8(x)       (((x) << 8) | (((x) & 0xff000000) >> 24))
+
+// Any block, one pixel per store.
+#define ROTATE_BLOCK_SINGLE(type, conv) \
+{ \
+  for (x = bx; x < ex; x++) \
+  { \
+    const type *s = src + by * src_pitch + x; \
+    type *d = dst + x * dst_height + (dst_height - 1 - by); \
+    for (y = by; y < ey; y++, s += src_pitch) \
+      *d-- = conv(*s); \
+  } \
+}
+
+// Blocks with an even number of rows whose column runs end on an even
+// pixel: rows y and y+1 land next to each other, y+1 at the lower address,
+// so they go out as one 32 bit store.
+#ifdef WORDS_BIGENDIAN
+#define PAIR16(lo, hi) (((unsigned int)(lo) << 16) | (hi))
+#else
+#define PAIR16(lo, hi) (((unsigned int)(hi) << 16) | (lo))
+#endif
+
+#define ROTATE_BLOCK_PAIRED(conv) \
+{ \
+  for (x = bx; x < ex; x++) \
+  { \
+    const unsigned short *s = src + by * src_pitch + x; \
+    unsigned int *d = (unsigned int *)(dst + x * dst_height + (dst_height - 2 - by)); \
+    for (y = by; y < ey; y += 2, s += 2 * src_pitch) \
+      *d-- = PAIR16(conv(s[src_pitch]), conv(s[0])); \
+  } \
+}
+
+// Walks the rectangle in blocks, block does the copy for
+// bx <= x < ex, by <= y < ey.
+#define ROTATE_RECT(block) \
+{ \
+  int bx, by, ex, ey, x, y; \
+  for (by = y1; by < y2; by += ROTATE_BLOCK) \
+  { \
+    ey = MIN(by + ROTATE_BLOCK, y2); \
+    for (bx = x1; bx < x2; bx += ROTATE_BLOCK) \
+    { \
+      ex = MIN(bx + ROTATE_BLOCK, x2); \
+      block \
+    } \
+  } \
+}
+
+#define ROTATE_BLOCK_16(conv) \
+  if (paired && !((ey - by) & 1) && !((dst_height - by) & 1)) \
+    ROTATE_BLOCK_PAIRED(conv) \
+  else \
+    ROTATE_BLOCK_SINGLE(unsigned short, conv)
+
+void V_RotateRect15(const unsigned short *src, int src_pitch,
+                    unsigned short *dst, int dst_height,
+                    int x1, int y1, int x2, int y2)
+{
+  dboolean paired = !((size_t)dst & 3) && !(dst_height & 1);
+
+  ROTATE_RECT(ROTATE_BLOCK_16(ARGB1555_2_RGBA5551))
+}
+
+void V_RotateRect16(const unsigned short *src, int src_pitch,
+                    unsigned short *dst, int dst_height,
+                    int x1, int y1, int x2, int y2)
+{
+  dboolean paired = !((size_t)dst & 3) && !(dst_height & 1);
+
+  ROTATE_RECT(ROTATE_BLOCK_16(RGB565_2_RGB565))
+}
+
+void V_RotateRect32(const unsigned int *src, int src_pitch,
+                    unsigned int *dst, int dst_height,
+                    int x1, int y1, int x2, int y2)
+{
+  ROTATE_RECT(ROTATE_BLOCK_SINGLE(unsigned int, ARGB8_2_RGBA8))
+}
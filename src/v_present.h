@@ -0,0 +1,60 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *  Present kernels for rotated framebuffers.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __V_PRESENT__
+#define __V_PRESENT__
+
+//
+// V_RotateRect15/16/32
+//
+// Copy the rectangle x1 <= x < x2, y1 <= y < y2 of a 15/16/32 bit screen
+// into a framebuffer stored column by column, bottom up, with dst_height
+// pixels per column (pixel x,y at dst[x * dst_height + dst_height-1 - y]),
+// converting the pixel format on the way:
+//  15 bit: ARGB1555 -> RGBA5551
+//  16 bit: RGB565 as is
+//  32 bit: ARGB8888 -> RGBA8888
+//
+
+void V_RotateRect15(const unsigned short *src, int src_pitch,
+                    unsigned short *dst, int dst_height,
+                    int x1, int y1, int x2, int y2);
+void V_RotateRect16(const unsigned short *src, int src_pitch,
+                    unsigned short *dst, int dst_height,
+                    int x1, int y1, int x2, int y2);
+void V_RotateRect32(const unsigned int *src, int src_pitch,
+                    unsigned int *dst, int dst_height,
+                    int x1, int y1, int x2, int y2);
+
+#endif
@@ -47,6 +47,7 @@
 #include "w_wad.h"   /* needed for color translation lump lookup */
 #include "v_video.h"
 #include "i_video.h"
+#include "i_system.h"
 #include "r_filter.h"
 #include "lprintf.h"
 #include "st_stuff.h"
@@ -177,13 +178,14 @@ void V_InitFlexTranTable(void)
     flexTranInit = true;
 
     // build RGB table
+    V_InitColorMatch(palette);
     for(r = 0; r < 32; r++)
     {
       for(g = 0; g < 32; g++)
       {
         for(b = 0; b < 32; b++)
         {
-          RGB32k[r][g][b] = V_BestColor(palette,
+          RGB32k[r][g][b] = V_MatchColor(
             MAKECOLOR(r), MAKECOLOR(g), MAKECOLOR(b));
         }
       }
@@ -291,6 +293,9 @@ static void FUNC_V_CopyRect(int srcscrn, int destscrn,
     return;
   }
 
+  if (destscrn == 0)
+    V_MarkRect(x, y, width, height);
+
   src = screens[srcscrn].data + screens[srcscrn].byte_pitch * y + x * pixel_depth;
   dest = screens[destscrn].data + screens[destscrn].byte_pitch * y + x * pixel_depth;
 
@@ -339,6 +344,9 @@ static void FUNC_V_FillFlat(int lump, int scrn, int x, int y, int width, int hei
 
   lump += firstflat;
 
+  if (scrn == 0)
+    V_MarkRect(x, y, width, height);
+
   // killough 4/17/98:
   data = W_CacheLumpNum(lump);
 
@@ -515,6 +523,9 @@ static void V_DrawMemPatch(int x, int y, int scrn, const rpatch_t *patch,
     bottom += params->deltay1;
   }
 
+  if (scrn == 0)
+    V_MarkRect(left, top, right - left + 1, bottom - top + 1);
+
   dcvars.texheight = patch->height;
   dcvars.iscale = DYI;
   dcvars.drawingmasked = MAX(patch->width, patch->height) > 8;
@@ -646,138 +657,139 @@ static void FUNC_V_DrawNumPatchPrecise(float x, float y, int scrn, int lump,
 unsigned short *V_Palette15 = NULL;
 unsigned short *V_Palette16 = NULL;
 unsigned int *V_Palette32 = NULL;
-static unsigned short *Palettes15 = NULL;
-static unsigned short *Palettes16 = NULL;
-static unsigned int *Palettes32 = NULL;
 static int currentPaletteIndex = 0;
 
-//
-// V_UpdateTrueColorPalette
-//
-void V_UpdateTrueColorPalette(video_mode_t mode) {
-  int i, w, p;
+// Every PLAYPAL palette at every color weight, one set per mode and gamma
+// level. A set is built the first time its gamma level is used and stays
+// until the sets of that mode go over TRUECOLOR_PALETTE_BUDGET bytes, so a
+// palette flash, and a gamma toggle back to a cached level, is a pointer swap.
+#define TRUECOLOR_GAMMA_LEVELS 5
+#define TRUECOLOR_PALETTE_BUDGET (4*1024*1024)
+
+typedef struct
+{
+  void *data;
+  size_t size;
+  unsigned int lastused;
+} truecolor_palettes_t;
+
+static truecolor_palettes_t truecolor_palettes[VID_MODEGL][TRUECOLOR_GAMMA_LEVELS];
+static unsigned int truecolor_palettes_age;
+
+static void V_BuildTrueColorPalettes(video_mode_t mode, void *dest,
+                                     const byte *pal, const byte *gtable, int numPals)
+{
+  int i, w;
   byte r,g,b;
   int nr,ng,nb;
   float t;
-  int paletteNum = (V_GetMode() == VID_MODEGL ? 0 : currentPaletteIndex);
-  static int usegammaOnLastPaletteGeneration = -1;
-  
-  int pplump = W_GetNumForName("PLAYPAL");
-  int gtlump = (W_CheckNumForName)("GAMMATBL",ns_prboom);
-  const byte *pal = W_CacheLumpNum(pplump);
-  // opengl doesn't use the gamma
-  const byte *const gtable = 
-    (const byte *)W_CacheLumpNum(gtlump) + 
-    (V_GetMode() == VID_MODEGL ? 0 : 256*(usegamma))
-  ;
-
-  int numPals = W_LumpLength(pplump) / (3*256);
   const float dontRoundAbove = 220;
   float roundUpR, roundUpG, roundUpB;
-  
-  if (usegammaOnLastPaletteGeneration != usegamma) {
-    if (Palettes15) free(Palettes15);
-    if (Palettes16) free(Palettes16);
-    if (Palettes32) free(Palettes32);
-    Palettes15 = NULL;
-    Palettes16 = NULL;
-    Palettes32 = NULL;
-    usegammaOnLastPaletteGeneration = usegamma;      
-  }
-  
-  if (mode == VID_MODE32) {
-    if (!Palettes32) {
-      // set int palette
-      Palettes32 = malloc(numPals*256*sizeof(int)*VID_NUMCOLORWEIGHTS);
-      for (p=0; p<numPals; p++) {
-        for (i=0; i<256; i++) {
-          r = gtable[pal[(256*p+i)*3+0]];
-          g = gtable[pal[(256*p+i)*3+1]];
-          b = gtable[pal[(256*p+i)*3+2]];
-          
-          // ideally, we should always round up, but very bright colors
-          // overflow the blending adds, so they don't get rounded.
-          roundUpR = (r > dontRoundAbove) ? 0 : 0.5f;
-          roundUpG = (g > dontRoundAbove) ? 0 : 0.5f;
-          roundUpB = (b > dontRoundAbove) ? 0 : 0.5f;
-                  
-          for (w=0; w<VID_NUMCOLORWEIGHTS; w++) {
-            t = (float)(w)/(float)(VID_NUMCOLORWEIGHTS-1);
-            nr = (int)(r*t+roundUpR);
-            ng = (int)(g*t+roundUpG);
-            nb = (int)(b*t+roundUpB);
-            Palettes32[((p*256+i)*VID_NUMCOLORWEIGHTS)+w] = (
-              (nr<<16) | (ng<<8) | nb
-            );
-          }
-        }
+
+  for (i=0; i<numPals*256; i++) {
+    r = gtable[pal[i*3+0]];
+    g = gtable[pal[i*3+1]];
+    b = gtable[pal[i*3+2]];
+
+    // ideally, we should always round up, but very bright colors
+    // overflow the blending adds, so they don't get rounded.
+    roundUpR = (r > dontRoundAbove) ? 0 : 0.5f;
+    roundUpG = (g > dontRoundAbove) ? 0 : 0.5f;
+    roundUpB = (b > dontRoundAbove) ? 0 : 0.5f;
+
+    for (w=0; w<VID_NUMCOLORWEIGHTS; w++) {
+      t = (float)(w)/(float)(VID_NUMCOLORWEIGHTS-1);
+      if (mode == VID_MODE32) {
+        nr = (int)(r*t+roundUpR);
+        ng = (int)(g*t+roundUpG);
+        nb = (int)(b*t+roundUpB);
+        ((unsigned int *)dest)[i*VID_NUMCOLORWEIGHTS+w] = (nr<<16) | (ng<<8) | nb;
+      } else if (mode == VID_MODE16) {
+        nr = (int)((r>>3)*t+roundUpR);
+        ng = (int)((g>>2)*t+roundUpG);
+        nb = (int)((b>>3)*t+roundUpB);
+        ((unsigned short *)dest)[i*VID_NUMCOLORWEIGHTS+w] = (nr<<11) | (ng<<5) | nb;
+      } else {
+        nr = (int)((r>>3)*t+roundUpR);
+        ng = (int)((g>>3)*t+roundUpG);
+        nb = (int)((b>>3)*t+roundUpB);
+        ((unsigned short *)dest)[i*VID_NUMCOLORWEIGHTS+w] = (nr<<10) | (ng<<5) | nb;
       }
     }
-    V_Palette32 = Palettes32 + paletteNum*256*VID_NUMCOLORWEIGHTS;
   }
-  else if (mode == VID_MODE16) {
-    if (!Palettes16) {
-      // set short palette
-      Palettes16 = malloc(numPals*256*sizeof(short)*VID_NUMCOLORWEIGHTS);
-      for (p=0; p<numPals; p++) {
-        for (i=0; i<256; i++) {
-          r = gtable[pal[(256*p+i)*3+0]];
-          g = gtable[pal[(256*p+i)*3+1]];
-          b = gtable[pal[(256*p+i)*3+2]];
-          
-          // ideally, we should always round up, but very bright colors
-          // overflow the blending adds, so they don't get rounded.
-          roundUpR = (r > dontRoundAbove) ? 0 : 0.5f;
-          roundUpG = (g > dontRoundAbove) ? 0 : 0.5f;
-          roundUpB = (b > dontRoundAbove) ? 0 : 0.5f;
-                   
-          for (w=0; w<VID_NUMCOLORWEIGHTS; w++) {
-            t = (float)(w)/(float)(VID_NUMCOLORWEIGHTS-1);
-            nr = (int)((r>>3)*t+roundUpR);
-            ng = (int)((g>>2)*t+roundUpG);
-            nb = (int)((b>>3)*t+roundUpB);
-            Palettes16[((p*256+i)*VID_NUMCOLORWEIGHTS)+w] = (
-              (nr<<11) | (ng<<5) | nb
-            );
-          }
-        }
-      }
+}
+
+// Drops least recently used sets of mode, other than keep, until the
+// sets fit the budget.
+static void V_TrimTrueColorPalettes(video_mode_t mode, truecolor_palettes_t *keep)
+{
+  truecolor_palettes_t *sets = truecolor_palettes[mode];
+
+  while (1) {
+    truecolor_palettes_t *oldest = NULL;
+    size_t total = 0;
+    int i;
+
+    for (i=0; i<TRUECOLOR_GAMMA_LEVELS; i++) {
+      if (!sets[i].data)
+        continue;
+      total += sets[i].size;
+      if (&sets[i] != keep && (!oldest || sets[i].lastused < oldest->lastused))
+        oldest = &sets[i];
     }
-    V_Palette16 = Palettes16 + paletteNum*256*VID_NUMCOLORWEIGHTS;
+
+    if (total <= TRUECOLOR_PALETTE_BUDGET || !oldest)
+      break;
+
+    free(oldest->data);
+    oldest->data = NULL;
   }
-  else if (mode == VID_MODE15) {
-    if (!Palettes15) {
-      // set short palette
-      Palettes15 = malloc(numPals*256*sizeof(short)*VID_NUMCOLORWEIGHTS);
-      for (p=0; p<numPals; p++) {
-        for (i=0; i<256; i++) {
-          r = gtable[pal[(256*p+i)*3+0]];
-          g = gtable[pal[(256*p+i)*3+1]];
-          b = gtable[pal[(256*p+i)*3+2]];
-          
-          // ideally, we should always round up, but very bright colors
-          // overflow the blending adds, so they don't get rounded.
-          roundUpR = (r > dontRoundAbove) ? 0 : 0.5f;
-          roundUpG = (g > dontRoundAbove) ? 0 : 0.5f;
-          roundUpB = (b > dontRoundAbove) ? 0 : 0.5f;
-                   
-          for (w=0; w<VID_NUMCOLORWEIGHTS; w++) {
-            t = (float)(w)/(float)(VID_NUMCOLORWEIGHTS-1);
-            nr = (int)((r>>3)*t+roundUpR);
-            ng = (int)((g>>3)*t+roundUpG);
-            nb = (int)((b>>3)*t+roundUpB);
-            Palettes15[((p*256+i)*VID_NUMCOLORWEIGHTS)+w] = (
-              (nr<<10) | (ng<<5) | nb
-            );
-          }
-        }
-      }
-    }
-    V_Palette15 = Palettes15 + paletteNum*256*VID_NUMCOLORWEIGHTS;
-  }       
-   
-  W_UnlockLumpNum(pplump);
-  W_UnlockLumpNum(gtlump);
+}
+
+//
+// V_UpdateTrueColorPalette
+//
+void V_UpdateTrueColorPalette(video_mode_t mode) {
+  // opengl doesn't use the gamma
+  int gamma = (V_GetMode() == VID_MODEGL ? 0 : BETWEEN(0, TRUECOLOR_GAMMA_LEVELS-1, usegamma));
+  int paletteNum = (V_GetMode() == VID_MODEGL ? 0 : currentPaletteIndex);
+  truecolor_palettes_t *set;
+  size_t entry = (mode == VID_MODE32 ? sizeof(int) : sizeof(short));
+
+  if (mode != VID_MODE15 && mode != VID_MODE16 && mode != VID_MODE32)
+    return;
+
+  set = &truecolor_palettes[mode][gamma];
+
+  if (!set->data) {
+    int pplump = W_GetNumForName("PLAYPAL");
+    int gtlump = (W_CheckNumForName)("GAMMATBL",ns_prboom);
+    const byte *pal = W_CacheLumpNum(pplump);
+    const byte *gtable = (const byte *)W_CacheLumpNum(gtlump) + 256*gamma;
+    int numPals = W_LumpLength(pplump) / (3*256);
+    int starttime = I_GetTime_MS();
+
+    set->size = numPals*256*VID_NUMCOLORWEIGHTS*entry;
+    set->data = malloc(set->size);
+    V_BuildTrueColorPalettes(mode, set->data, pal, gtable, numPals);
+
+    W_UnlockLumpNum(pplump);
+    W_UnlockLumpNum(gtlump);
+
+    lprintf(LO_INFO, "V_UpdateTrueColorPalette: %d palettes for gamma %d built in %d ms\n",
+            numPals, gamma, I_GetTime_MS() - starttime);
+
+    V_TrimTrueColorPalettes(mode, set);
+  }
+
+  set->lastused = ++truecolor_palettes_age;
+
+  if (mode == VID_MODE32)
+    V_Palette32 = (unsigned int *)set->data + paletteNum*256*VID_NUMCOLORWEIGHTS;
+  else if (mode == VID_MODE16)
+    V_Palette16 = (unsigned short *)set->data + paletteNum*256*VID_NUMCOLORWEIGHTS;
+  else
+    V_Palette15 = (unsigned short *)set->data + paletteNum*256*VID_NUMCOLORWEIGHTS;
 }
 
 
@@ -785,21 +797,16 @@ void V_UpdateTrueColorPalette(video_mode_t mode) {
 // V_DestroyTrueColorPalette
 //---------------------------------------------------------------------------
 static void V_DestroyTrueColorPalette(video_mode_t mode) {
-  if (mode == VID_MODE15) {
-    if (Palettes15) free(Palettes15);
-    Palettes15 = NULL;
-    V_Palette15 = NULL;
-  }
-  if (mode == VID_MODE16) {
-    if (Palettes16) free(Palettes16);
-    Palettes16 = NULL;
-    V_Palette16 = NULL;
-  }
-  if (mode == VID_MODE32) {
-    if (Palettes32) free(Palettes32);
-    Palettes32 = NULL;
-    V_Palette32 = NULL;
+  int i;
+
+  for (i=0; i<TRUECOLOR_GAMMA_LEVELS; i++) {
+    if (truecolor_palettes[mode][i].data) free(truecolor_palettes[mode][i].data);
+    truecolor_palettes[mode][i].data = NULL;
   }
+
+  if (mode == VID_MODE15) V_Palette15 = NULL;
+  if (mode == VID_MODE16) V_Palette16 = NULL;
+  if (mode == VID_MODE32) V_Palette32 = NULL;
 }
 
 void V_DestroyUnusedTrueColorPalettes(void) {
@@ -842,6 +849,8 @@ static void V_FillRect15(int scrn, int x, int y, int width, int height, byte col
   unsigned short* dest = (unsigned short *)screens[scrn].data + x + y*screens[scrn].short_pitch;
   int w;
   short c = VID_PAL15(colour, VID_COLORWEIGHTMASK);
+  if (scrn == 0)
+    V_MarkRect(x, y, width, height);
   while (height--) {
     for (w=0; w<width; w++) {
       dest[w] = c;
@@ -855,6 +864,8 @@ static void V_FillRect16(int scrn, int x, int y, int width, int height, byte col
   unsigned short* dest = (unsigned short *)screens[scrn].data + x + y*screens[scrn].short_pitch;
   int w;
   short c = VID_PAL16(colour, VID_COLORWEIGHTMASK);
+  if (scrn == 0)
+    V_MarkRect(x, y, width, height);
   while (height--) {
     for (w=0; w<width; w++) {
       dest[w] = c;
@@ -868,6 +879,8 @@ static void V_FillRect32(int scrn, int x, int y, int width, int height, byte col
   unsigned int* dest = (unsigned int *)screens[scrn].data + x + y*screens[scrn].int_pitch;
   int w;
   int c = VID_PAL32(colour, VID_COLORWEIGHTMASK);
+  if (scrn == 0)
+    V_MarkRect(x, y, width, height);
   while (height--) {
     for (w=0; w<width; w++) {
       dest[w] = c;
@@ -1085,6 +1098,8 @@ void V_AllocScreens(void) {
 
   for (i=0; i<NUM_SCREENS; i++)
     V_AllocScreen(&screens[i]);
+
+  V_MarkScreenDirty();
 }
 
 //
@@ -1121,6 +1136,15 @@ static void V_PlotPixel32(int scrn, int x, int y, byte color) {
 
 #define PUTDOT(xx,yy,cc) V_PlotPixel(0,xx,yy,(byte)cc)
 
+// Wu lines blend into the pixel next to the ideal one
+static void V_MarkLine(const fline_t *fl)
+{
+  int x = MIN(fl->a.x, fl->b.x);
+  int y = MIN(fl->a.y, fl->b.y);
+
+  V_MarkRect(x - 1, y - 1, MAX(fl->a.x, fl->b.x) - x + 3, MAX(fl->a.y, fl->b.y) - y + 3);
+}
+
 //
 // WRAP_V_DrawLine()
 //
@@ -1160,6 +1184,8 @@ static void WRAP_V_DrawLine(fline_t* fl, int color)
   }
 #endif
 
+  V_MarkLine(fl);
+
   dx = fl->b.x - fl->a.x;
   ax = 2 * (dx<0 ? -dx : dx);
   sx = dx<0 ? -1 : 1;
@@ -1282,6 +1308,8 @@ void WRAP_V_DrawLineWu(fline_t *fl, int color)
   int dx, dy, xdir = 1;
   int x, y;   
 
+  V_MarkLine(fl);
+
   // swap end points if necessary
   if(fl->a.y > fl->b.y)
   {
@@ -1688,3 +1716,228 @@ int V_BestColor(const unsigned char *palette, int r, int g, int b)
 
   return bestcolor;
 }
+
+//
+// Nearest color search
+//
+// RGB space is cut into cubes of COLORMATCH_CELL units. For each cube we
+// keep the palette entries that can be nearest to some point inside it:
+// those whose distance to the cube is no more than the smallest distance
+// any entry has to the farthest corner. The lists are exact, ties included,
+// and built the first time a cube is looked at, so a search only scans the
+// few entries near the target instead of all 256.
+//
+
+#define COLORMATCH_SHIFT  4
+#define COLORMATCH_CELL   (1 << COLORMATCH_SHIFT)
+#define COLORMATCH_CELLS  (256 >> COLORMATCH_SHIFT)
+
+static struct
+{
+  unsigned char palette[256*3];
+  dboolean valid;
+  int start[COLORMATCH_CELLS][COLORMATCH_CELLS][COLORMATCH_CELLS];
+  short count[COLORMATCH_CELLS][COLORMATCH_CELLS][COLORMATCH_CELLS];
+  byte *pool;
+  int poolsize, poolmax;
+} colormatch;
+
+// squared distances from c to the nearest and farthest point of [lo, lo+CELL]
+static void V_ColorMatchRange(int c, int lo, int *dmin, int *dmax)
+{
+  int hi = lo + COLORMATCH_CELL;
+  int near_d = c < lo ? lo - c : c > hi ? c - hi : 0;
+  int far_d = MAX(c - lo, hi - c);
+
+  *dmin += near_d * near_d;
+  *dmax += far_d * far_d;
+}
+
+static void V_BuildColorMatchCell(int cr, int cg, int cb)
+{
+  int dmin[256], bound = INT_MAX;
+  int i, n = 0;
+  const unsigned char *p;
+
+  for (i = 0, p = colormatch.palette; i < 256; i++, p += 3)
+  {
+    int dmax = 0;
+
+    dmin[i] = 0;
+    V_ColorMatchRange(p[0], cr << COLORMATCH_SHIFT, &dmin[i], &dmax);
+    V_ColorMatchRange(p[1], cg << COLORMATCH_SHIFT, &dmin[i], &dmax);
+    V_ColorMatchRange(p[2], cb << COLORMATCH_SHIFT, &dmin[i], &dmax);
+    if (dmax < bound)
+      bound = dmax;
+  }
+
+  if (colormatch.poolsize + 256 > colormatch.poolmax)
+  {
+    colormatch.poolmax = colormatch.poolmax ? colormatch.poolmax * 2 : 16384;
+    colormatch.pool = realloc(colormatch.pool, colormatch.poolmax);
+  }
+
+  colormatch.start[cr][cg][cb] = colormatch.poolsize;
+  for (i = 0; i < 256; i++)
+    if (dmin[i] <= bound)
+      colormatch.pool[colormatch.poolsize + n++] = i;
+  colormatch.poolsize += n;
+  colormatch.count[cr][cg][cb] = n;
+}
+
+//
+// V_InitColorMatch
+//
+// Selects the palette for V_ColorCandidates and V_MatchColor. The lists
+// already built are kept as long as the palette contents don't change.
+//
+
+void V_InitColorMatch(const unsigned char *palette)
+{
+  if (colormatch.valid && !memcmp(colormatch.palette, palette, sizeof(colormatch.palette)))
+    return;
+
+  memcpy(colormatch.palette, palette, sizeof(colormatch.palette));
+  memset(colormatch.count, 0, sizeof(colormatch.count));
+  colormatch.poolsize = 0;
+  colormatch.valid = true;
+}
+
+//
+// V_ColorCandidates
+//
+// Returns the palette entries, in ascending order, that can be nearest to
+// any color from (r,g,b) up to but not including (r+1,g+1,b+1), so callers
+// can search fractional colors with their own metric and tie rule. The
+// list is only valid until the next call.
+//
+
+const byte *V_ColorCandidates(int r, int g, int b, int *count)
+{
+  int cr = r >> COLORMATCH_SHIFT;
+  int cg = g >> COLORMATCH_SHIFT;
+  int cb = b >> COLORMATCH_SHIFT;
+
+  if (!colormatch.count[cr][cg][cb])
+    V_BuildColorMatchCell(cr, cg, cb);
+
+  *count = colormatch.count[cr][cg][cb];
+  return colormatch.pool + colormatch.start[cr][cg][cb];
+}
+
+// Same result as V_BestColor for the palette given to V_InitColorMatch
+int V_MatchColor(int r, int g, int b)
+{
+  int i, count, bestcolor = 0;
+  int bestdist = INT_MAX;
+  const byte *list = V_ColorCandidates(r, g, b, &count);
+
+  for (i = 0; i < count; i++)
+  {
+    const unsigned char *p = colormatch.palette + list[i] * 3;
+    int dr = r - p[0];
+    int dg = g - p[1];
+    int db = b - p[2];
+    int dist = dr * dr + dg * dg + db * db;
+
+    if (dist < bestdist)
+    {
+      bestdist = dist;
+      bestcolor = list[i];
+    }
+  }
+
+  return bestcolor;
+}
+
+//
+// Dirty regions
+//
+// Everything drawn into screen 0 marks the tiles it touches; the platform
+// present asks for V_GetPresentTiles once per frame and converts only
+// those. The framebuffer it draws into holds the frame before the previous
+// one (double buffering), so a tile is presented if it changed in either of
+// the last two frames.
+//
+
+int render_dirtyrects;
+unsigned int v_presented_bytes;
+
+static byte *dirtytiles;     // marked this frame
+static byte *lastdirtytiles; // marked the frame before
+static byte *presenttiles;
+static int dirtycols, dirtyrows;
+
+static void V_InitDirtyTiles(void)
+{
+  int cols = (SCREENWIDTH + V_DIRTY_TILE - 1) >> V_DIRTY_TILE_SHIFT;
+  int rows = (SCREENHEIGHT + V_DIRTY_TILE - 1) >> V_DIRTY_TILE_SHIFT;
+
+  if (cols != dirtycols || rows != dirtyrows)
+  {
+    dirtycols = cols;
+    dirtyrows = rows;
+    dirtytiles = realloc(dirtytiles, cols * rows);
+    lastdirtytiles = realloc(lastdirtytiles, cols * rows);
+    presenttiles = realloc(presenttiles, cols * rows);
+  }
+}
+
+void V_MarkRect(int x, int y, int width, int height)
+{
+  int tx, ty, x2, y2;
+
+  if (!dirtytiles)
+    return;
+
+  x2 = MIN(x + width, SCREENWIDTH) - 1;
+  y2 = MIN(y + height, SCREENHEIGHT) - 1;
+  x = MAX(x, 0);
+  y = MAX(y, 0);
+
+  if (x > x2 || y > y2)
+    return;
+
+  x >>= V_DIRTY_TILE_SHIFT;
+  x2 >>= V_DIRTY_TILE_SHIFT;
+  y2 >>= V_DIRTY_TILE_SHIFT;
+
+  for (ty = y >> V_DIRTY_TILE_SHIFT; ty <= y2; ty++)
+    for (tx = x; tx <= x2; tx++)
+      dirtytiles[ty * dirtycols + tx] = 1;
+}
+
+void V_MarkScreenDirty(void)
+{
+  V_InitDirtyTiles();
+  memset(dirtytiles, 1, dirtycols * dirtyrows);
+  memset(lastdirtytiles, 1, dirtycols * dirtyrows);
+}
+
+const byte *V_GetPresentTiles(int *cols, int *rows)
+{
+  byte *tmp;
+  int i;
+
+  if (!dirtytiles)
+    V_MarkScreenDirty();
+
+  *cols = dirtycols;
+  *rows = dirtyrows;
+
+  if (!render_dirtyrects)
+  {
+    memset(presenttiles, 1, dirtycols * dirtyrows);
+    return presenttiles;
+  }
+
+  for (i = 0; i < dirtycols * dirtyrows; i++)
+    presenttiles[i] = dirtytiles[i] | lastdirtytiles[i];
+
+  tmp = lastdirtytiles;
+  lastdirtytiles = dirtytiles;
+  dirtytiles = tmp;
+  memset(dirtytiles, 0, dirtycols * dirtyrows);
+
+  return presenttiles;
+}
@@ -300,9 +300,26 @@ void V_GetWideRect(int *x, int *y, int *w, int *h, enum patch_translation_e flag
 
 int V_BestColor(const unsigned char *palette, int r, int g, int b);
 
+// nearest color search over cached candidate lists, 0 <= r,g,b <= 255
+void V_InitColorMatch(const unsigned char *palette);
+const byte *V_ColorCandidates(int r, int g, int b, int *count);
+int V_MatchColor(int r, int g, int b);
+
 // [FG] colored blood and gibs
 int V_BloodColor(int blood);
 
+// Dirty regions of screen 0 in V_DIRTY_TILE x V_DIRTY_TILE tiles, so the
+// present only has to convert what changed
+#define V_DIRTY_TILE_SHIFT 4
+#define V_DIRTY_TILE (1 << V_DIRTY_TILE_SHIFT)
+
+extern int render_dirtyrects;
+extern unsigned int v_presented_bytes;
+
+void V_MarkRect(int x, int y, int width, int height);
+void V_MarkScreenDirty(void);
+const byte *V_GetPresentTiles(int *cols, int *rows);
+
 #ifdef GL_DOOM
 #include "gl_struct.h"
 #endif
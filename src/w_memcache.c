@@ -116,7 +116,12 @@ const void *W_CacheLumpNum(int lump)
 #endif
 
   if (!cachelump[lump].cache)      // read the lump in
+  {
+    zone_cachestats.misses++;
     W_ReadLump(lump, Z_Malloc(W_LumpLength(lump), PU_CACHE, &cachelump[lump].cache));
+  }
+  else
+    zone_cachestats.hits++;
 
   /* cph - if wasn't locked but now is, tell z_zone to hold it */
   if (!cachelump[lump].locks && locks) {
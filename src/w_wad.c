@@ -57,6 +57,8 @@
 #include "e6y.h"
 
 #include "m_io.h"
+#include "m_argv.h"
+#include "md5.h"
 
 //
 // GLOBALS
@@ -127,18 +129,14 @@ char *AddDefaultExtension(char *path, const char *ext)
 // CPhipps - source is an enum
 //
 // proff - changed using pointer to wadfile_info_t
-static void W_AddFile(wadfile_info_t *wadfile) 
-// killough 1/31/98: static, const
+//
+// W_OpenFile
+// Opens a wad or lump file and leaves its handle in wadfile. Split from
+// W_AddFile so that the lump directory can come from the lump index
+// instead of the file itself.
+//
+static void W_OpenFile(wadfile_info_t *wadfile)
 {
-  wadinfo_t   header;
-  lumpinfo_t* lump_p;
-  unsigned    i;
-  int         length;
-  int         startlump;
-  filelump_t  *fileinfo, *fileinfo2free=NULL; //killough
-  filelump_t  singleinfo;
-  int         flags = 0;
-
   if (wadfile->src == source_skip)
   {
     return;
@@ -174,6 +172,25 @@ static void W_AddFile(wadfile_info_t *wadfile)
 
   //jff 8/3/98 use logical output routine
   lprintf (LO_INFO," adding %s\n",wadfile->name);
+}
+
+static void W_AddFile(wadfile_info_t *wadfile) 
+// killough 1/31/98: static, const
+{
+  wadinfo_t   header;
+  lumpinfo_t* lump_p;
+  unsigned    i;
+  int         length;
+  int         startlump;
+  filelump_t  *fileinfo, *fileinfo2free=NULL; //killough
+  filelump_t  singleinfo;
+  int         flags = 0;
+
+  if (wadfile->src == source_skip || wadfile->handle == -1)
+  {
+    return;
+  }
+
   startlump = numlumps;
 
   // mark lumps from internal resource
@@ -190,6 +207,12 @@ static void W_AddFile(wadfile_info_t *wadfile)
     }
   }
 
+  if (W_IsZipFile(wadfile->name))
+    {
+      W_AddZipFile(wadfile, flags);
+      return;
+    }
+
   if (  strlen(wadfile->name)<=4 || 
 	      (
           strcasecmp(wadfile->name+strlen(wadfile->name)-4,".wad") && 
@@ -228,6 +251,7 @@ static void W_AddFile(wadfile_info_t *wadfile)
     for (i=startlump ; (int)i<numlumps ; i++,lump_p++, fileinfo++)
       {
         lump_p->flags = flags;
+        lump_p->compressed_size = 0;
         lump_p->wadfile = wadfile;                    //  killough 4/25/98
         lump_p->position = LittleLong(fileinfo->filepos);
         lump_p->size = LittleLong(fileinfo->size);
@@ -482,6 +506,194 @@ int W_ListNumFromName(const char *name, int lump)
   return i;
 }
 
+//
+// Lump index
+//
+// The merged, coalesced and hashed lumpinfo table only depends on the set of
+// files loaded, so it is saved to lumpindex.dat and reused by later runs that
+// load the same files. The files are identified by an MD5 digest over their
+// paths, sources, sizes and modification times; reading and hashing the
+// whole wad contents would cost more than the directory scan it replaces.
+//
+
+#define LUMPINDEX_MAGIC "PRBLIDX2"
+
+typedef struct
+{
+  char magic[8];
+  unsigned char key[16];
+  int lumpinfo_size;
+  int numlumps;
+  int have_internal_hires;
+} lumpindex_header_t;
+
+typedef struct
+{
+  char name[8];
+  int size;
+  int index, next;
+  int li_namespace;
+  int wadfile;    // index into wadfiles[], -1 for markers
+  int position;
+  int source;
+  int flags;
+  int compressed_size;
+} lumpindex_lump_t;
+
+static char *W_LumpIndexFileName(void)
+{
+  char *fname;
+  int fnlen;
+
+  fnlen = doom_snprintf(NULL, 0, "%s/lumpindex.dat", I_DoomExeDir());
+  fname = malloc(fnlen+1);
+  doom_snprintf(fname, fnlen+1, "%s/lumpindex.dat", I_DoomExeDir());
+
+  return fname;
+}
+
+static void W_LumpIndexKey(unsigned char key[16])
+{
+  struct MD5Context md5;
+  size_t i;
+
+  MD5Init(&md5);
+  for (i = 0; i < numwadfiles; i++)
+  {
+    struct stat st;
+    int info[3];
+
+    info[0] = wadfiles[i].src;
+    info[1] = -1;
+    info[2] = -1;
+    if (wadfiles[i].src != source_skip && wadfiles[i].handle != -1 &&
+        fstat(wadfiles[i].handle, &st) == 0)
+    {
+      info[1] = (int)st.st_size;
+      info[2] = (int)st.st_mtime;
+    }
+    MD5Update(&md5, (const md5byte *)wadfiles[i].name, strlen(wadfiles[i].name) + 1);
+    MD5Update(&md5, (const md5byte *)info, sizeof(info));
+  }
+  MD5Final(key, &md5);
+}
+
+static dboolean W_LoadLumpIndex(const unsigned char key[16])
+{
+  lumpindex_header_t header;
+  lumpindex_lump_t *lumps;
+  char *fname;
+  FILE *fp;
+  dboolean ok = false;
+  int i;
+
+  fname = W_LumpIndexFileName();
+  fp = M_fopen(fname, "rb");
+  free(fname);
+  if (!fp)
+    return false;
+
+  if (fread(&header, sizeof(header), 1, fp) == 1 &&
+      !memcmp(header.magic, LUMPINDEX_MAGIC, sizeof(header.magic)) &&
+      !memcmp(header.key, key, sizeof(header.key)) &&
+      header.lumpinfo_size == sizeof(lumpinfo_t) &&
+      header.numlumps > 0)
+  {
+    // the whole table is read in one go
+    lumps = malloc(header.numlumps * sizeof(*lumps));
+    if (fread(lumps, sizeof(*lumps), header.numlumps, fp) == (size_t)header.numlumps)
+    {
+      ok = true;
+      lumpinfo = malloc(header.numlumps * sizeof(lumpinfo_t));
+      for (i = 0; i < header.numlumps; i++)
+      {
+        lumpinfo_t *lump = &lumpinfo[i];
+
+        // a damaged index must not point outside the tables, rebuild
+        // from the wads instead
+        if (lumps[i].wadfile < -1 || lumps[i].wadfile >= (int)numwadfiles ||
+            lumps[i].index < -1 || lumps[i].index >= header.numlumps ||
+            lumps[i].next < -1 || lumps[i].next >= header.numlumps)
+        {
+          ok = false;
+          break;
+        }
+        memcpy(lump->name, lumps[i].name, 8);
+        lump->name[8] = 0;
+        lump->size = lumps[i].size;
+        lump->index = lumps[i].index;
+        lump->next = lumps[i].next;
+        lump->li_namespace = lumps[i].li_namespace;
+        lump->wadfile = lumps[i].wadfile < 0 ? NULL : &wadfiles[lumps[i].wadfile];
+        lump->position = lumps[i].position;
+        lump->source = lumps[i].source;
+        lump->flags = lumps[i].flags;
+        lump->compressed_size = lumps[i].compressed_size;
+      }
+      if (ok)
+      {
+        numlumps = header.numlumps;
+        r_have_internal_hires = header.have_internal_hires;
+      }
+      else
+      {
+        lprintf(LO_WARN, "W_LoadLumpIndex: lump index is damaged, rebuilding\n");
+        free(lumpinfo);
+        lumpinfo = NULL;
+      }
+    }
+    free(lumps);
+  }
+  fclose(fp);
+
+  return ok;
+}
+
+static void W_SaveLumpIndex(const unsigned char key[16])
+{
+  lumpindex_header_t header;
+  lumpindex_lump_t *lumps;
+  char *fname;
+  FILE *fp;
+  int i;
+
+  fname = W_LumpIndexFileName();
+  fp = M_fopen(fname, "wb");
+  free(fname);
+  if (!fp)
+    return;
+
+  memcpy(header.magic, LUMPINDEX_MAGIC, sizeof(header.magic));
+  memcpy(header.key, key, sizeof(header.key));
+  header.lumpinfo_size = sizeof(lumpinfo_t);
+  header.numlumps = numlumps;
+  header.have_internal_hires = r_have_internal_hires;
+
+  lumps = calloc(numlumps, sizeof(*lumps));
+  for (i = 0; i < numlumps; i++)
+  {
+    const lumpinfo_t *lump = &lumpinfo[i];
+
+    memcpy(lumps[i].name, lump->name, 8);
+    lumps[i].size = lump->size;
+    lumps[i].index = lump->index;
+    lumps[i].next = lump->next;
+    lumps[i].li_namespace = lump->li_namespace;
+    lumps[i].wadfile = lump->wadfile ? (int)(lump->wadfile - wadfiles) : -1;
+    lumps[i].position = lump->position;
+    lumps[i].source = lump->source;
+    lumps[i].flags = lump->flags;
+    lumps[i].compressed_size = lump->compressed_size;
+  }
+
+  if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+      fwrite(lumps, sizeof(*lumps), numlumps, fp) != (size_t)numlumps)
+    lprintf(LO_WARN, "W_SaveLumpIndex: failed to write lump index\n");
+
+  free(lumps);
+  fclose(fp);
+}
+
 // W_Init
 // Loads each of the files in the wadfiles array.
 // All files are optional, but at least one file
@@ -502,33 +714,52 @@ size_t numwadfiles = 0; // CPhipps - size of the wadfiles array (dynamic, no lim
 
 void W_Init(void)
 {
+  unsigned char key[16];
+  dboolean use_index = !M_CheckParm("-nolumpindex");
+  int i;
+
   // CPhipps - start with nothing
 
   numlumps = 0; lumpinfo = NULL;
 
-  { // CPhipps - new wadfiles array used 
-    // open all the files, load headers, and count lumps
-    int i;
-    for (i=0; (size_t)i<numwadfiles; i++)
-      W_AddFile(&wadfiles[i]);
-  }
+  // open all the files
+  for (i=0; (size_t)i<numwadfiles; i++)
+    W_OpenFile(&wadfiles[i]);
 
-  if (!numlumps)
-    I_Error ("W_Init: No files found");
+  if (use_index)
+    W_LumpIndexKey(key);
 
-  //jff 1/23/98
-  // get all the sprites and flats into one marked block each
-  // killough 1/24/98: change interface to use M_START/M_END explicitly
-  // killough 4/17/98: Add namespace tags to each entry
-  // killough 4/4/98: add colormap markers
-  W_CoalesceMarkedResource("S_START", "S_END", ns_sprites);
-  W_CoalesceMarkedResource("F_START", "F_END", ns_flats);
-  W_CoalesceMarkedResource("C_START", "C_END", ns_colormaps);
-  W_CoalesceMarkedResource("B_START", "B_END", ns_prboom);
-  r_have_internal_hires = ( 0 < W_CoalesceMarkedResource("HI_START", "HI_END", ns_hires));
+  if (use_index && W_LoadLumpIndex(key))
+  {
+    lprintf(LO_INFO, "W_Init: using lump index (%d lumps)\n", numlumps);
+  }
+  else
+  {
+    // CPhipps - new wadfiles array used 
+    // load headers and count lumps
+    for (i=0; (size_t)i<numwadfiles; i++)
+      W_AddFile(&wadfiles[i]);
 
-  // killough 1/31/98: initialize lump hash table
-  W_HashLumps();
+    if (!numlumps)
+      I_Error ("W_Init: No files found");
+
+    //jff 1/23/98
+    // get all the sprites and flats into one marked block each
+    // killough 1/24/98: change interface to use M_START/M_END explicitly
+    // killough 4/17/98: Add namespace tags to each entry
+    // killough 4/4/98: add colormap markers
+    W_CoalesceMarkedResource("S_START", "S_END", ns_sprites);
+    W_CoalesceMarkedResource("F_START", "F_END", ns_flats);
+    W_CoalesceMarkedResource("C_START", "C_END", ns_colormaps);
+    W_CoalesceMarkedResource("B_START", "B_END", ns_prboom);
+    r_have_internal_hires = ( 0 < W_CoalesceMarkedResource("HI_START", "HI_END", ns_hires));
+
+    // killough 1/31/98: initialize lump hash table
+    W_HashLumps();
+
+    if (use_index)
+      W_SaveLumpIndex(key);
+  }
 
   /* cph 2001/07/07 - separated cache setup */
   lprintf(LO_INFO,"W_InitCache\n");
@@ -589,7 +820,11 @@ void W_ReadLump(int lump, void *dest)
 #endif
 
     {
-      if (l->wadfile)
+      if (l->wadfile && (l->flags & (LUMP_ZIPENTRY | LUMP_DEFLATED)))
+      {
+        W_ReadZipLump(l, dest);
+      }
+      else if (l->wadfile)
       {
         lseek(l->wadfile->handle, l->position, SEEK_SET);
         I_Read(l->wadfile->handle, dest, l->size);
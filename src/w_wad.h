@@ -39,6 +39,8 @@
 #pragma interface
 #endif
 
+#include "doomtype.h"
+
 //
 // TYPES
 //
@@ -126,12 +128,15 @@ typedef struct
   int position;
   wad_source_t source;
   int flags; //e6y
+  int compressed_size; // size in the archive, for LUMP_DEFLATED lumps
 } lumpinfo_t;
 
 // e6y: lump flags
 #define LUMP_STATIC 0x00000001 /* assigned gltexture should be static */
 #define LUMP_CM2RGB 0x00000002 /* for fake colormap for hires patches */
 #define LUMP_PRBOOM 0x00000004 /* from internal resource */
+#define LUMP_ZIPENTRY 0x00000008 /* position is a zip local header, not data */
+#define LUMP_DEFLATED 0x00000010 /* deflate compressed in a zip archive */
 
 extern lumpinfo_t *lumpinfo;
 extern int        numlumps;
@@ -168,4 +173,9 @@ void ExtractFileBase(const char *, char *);       // killough
 unsigned W_LumpNameHash(const char *s);           // killough 1/31/98
 void W_HashLumps(void);                           // cph 2001/07/07 - made public
 
+// PK3/ZIP archives (w_zip.c)
+dboolean W_IsZipFile(const char *name);
+void W_AddZipFile(wadfile_info_t *wadfile, int flags);
+void W_ReadZipLump(lumpinfo_t *l, void *dest);
+
 #endif
@@ -0,0 +1,310 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2001 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *      PK3/ZIP resource archives.
+ *
+ *      Only the central directory is read when the archive is added. Each
+ *      file becomes a lump whose position points at its local header; the
+ *      data offset is resolved and deflated entries are inflated when the
+ *      lump is first read, so decompressed data only ever lives in the
+ *      purgable lump cache.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef _MSC_VER
+#include <io.h>
+#endif
+#include <fcntl.h>
+#include <strings.h>
+#include <unistd.h>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#include "doomstat.h"
+#include "doomtype.h"
+#include "i_system.h"
+#include "w_wad.h"
+#include "lprintf.h"
+
+#define ZIP_LOCAL_SIG     0x04034b50
+#define ZIP_CENTRAL_SIG   0x02014b50
+#define ZIP_END_SIG       0x06054b50
+
+#define ZIP_LOCAL_SIZE    30
+#define ZIP_CENTRAL_SIZE  46
+#define ZIP_END_SIZE      22
+
+#define ZIP_METHOD_STORED   0
+#define ZIP_METHOD_DEFLATED 8
+
+// archive fields are little endian and unaligned
+#define ZIP_WORD(p)  ((p)[0] | ((p)[1] << 8))
+#define ZIP_LONG(p)  ((unsigned int)ZIP_WORD(p) | ((unsigned int)ZIP_WORD((p)+2) << 16))
+
+//
+// Folder to namespace mapping. Files in the archive root and in the folders
+// below are visible by their base name; anything else is ignored, as other
+// ports do.
+//
+
+static const struct {
+  const char *folder;
+  li_namespace_e li_namespace;
+} zip_folders[] = {
+  {"",           ns_global},
+  {"sprites/",   ns_sprites},
+  {"flats/",     ns_flats},
+  {"colormaps/", ns_colormaps},
+  {"hires/",     ns_hires},
+  {"graphics/",  ns_global},
+  {"patches/",   ns_global},
+  {"sounds/",    ns_global},
+  {"music/",     ns_global},
+  {"textures/",  ns_global},
+  {NULL}
+};
+
+dboolean W_IsZipFile(const char *name)
+{
+  size_t len = strlen(name);
+
+  return len > 4 &&
+    (!strcasecmp(name + len - 4, ".pk3") || !strcasecmp(name + len - 4, ".zip"));
+}
+
+// Locates the end of central directory record, which is followed by an
+// archive comment of up to 64k.
+
+static int W_FindZipEnd(int handle, int filelen, byte *end)
+{
+  int searchlen = MIN(filelen, ZIP_END_SIZE + 0xffff);
+  byte *buf = malloc(searchlen);
+  int i, result = -1;
+
+  lseek(handle, filelen - searchlen, SEEK_SET);
+  I_Read(handle, buf, searchlen);
+
+  for (i = searchlen - ZIP_END_SIZE; i >= 0; i--)
+  {
+    if (ZIP_LONG(buf + i) == ZIP_END_SIG)
+    {
+      memcpy(end, buf + i, ZIP_END_SIZE);
+      result = filelen - searchlen + i;
+      break;
+    }
+  }
+
+  free(buf);
+  return result;
+}
+
+// Maps an archive path to a namespace and lump name, returns false for
+// entries that are not visible as lumps.
+
+static dboolean W_ZipLumpName(const char *path, int pathlen, char *name,
+                              li_namespace_e *li_namespace)
+{
+  const char *base, *p;
+  int i, len;
+
+  base = path;
+  for (p = path; p < path + pathlen; p++)
+    if (*p == '/')
+      base = p + 1;
+
+  for (i = 0; zip_folders[i].folder; i++)
+  {
+    len = strlen(zip_folders[i].folder);
+    if (base - path == len && !strncasecmp(path, zip_folders[i].folder, len))
+      break;
+  }
+  if (!zip_folders[i].folder)
+    return false;
+
+  *li_namespace = zip_folders[i].li_namespace;
+
+  memset(name, 0, 8);
+  for (len = 0; len < 8 && base + len < path + pathlen && base[len] != '.'; len++)
+    name[len] = toupper(base[len]);
+
+  return len > 0;
+}
+
+//
+// W_AddZipFile
+// Appends the files of a PK3/ZIP archive to the lump directory.
+//
+
+void W_AddZipFile(wadfile_info_t *wadfile, int flags)
+{
+  byte end[ZIP_END_SIZE] = {0};
+  byte *dir, *entry;
+  unsigned int dirofs, dirsize;
+  int filelen, entries;
+  int i, skipped = 0;
+
+  filelen = I_Filelength(wadfile->handle);
+  if (W_FindZipEnd(wadfile->handle, filelen, end) < 0)
+    I_Error("W_AddZipFile: %s is not a zip archive", wadfile->name);
+
+  entries = ZIP_WORD(end + 10);
+  dirsize = ZIP_LONG(end + 12);
+  dirofs = ZIP_LONG(end + 16);
+
+  // dirofs + dirsize could wrap around
+  if (dirofs > (unsigned int)filelen || dirsize > (unsigned int)filelen - dirofs)
+    I_Error("W_AddZipFile: %s has a corrupt central directory", wadfile->name);
+
+  dir = malloc(dirsize);
+  lseek(wadfile->handle, dirofs, SEEK_SET);
+  I_Read(wadfile->handle, dir, dirsize);
+
+  lumpinfo = realloc(lumpinfo, (numlumps + entries) * sizeof(lumpinfo_t));
+
+  for (i = 0, entry = dir; i < entries; i++)
+  {
+    lumpinfo_t *lump_p;
+    li_namespace_e li_namespace;
+    char name[8];
+    int method, namelen;
+
+    if (entry + ZIP_CENTRAL_SIZE > dir + dirsize ||
+        ZIP_LONG(entry) != ZIP_CENTRAL_SIG)
+      I_Error("W_AddZipFile: %s has a corrupt central directory", wadfile->name);
+
+    method = ZIP_WORD(entry + 10);
+    namelen = ZIP_WORD(entry + 28);
+
+    if (entry + ZIP_CENTRAL_SIZE + namelen > dir + dirsize)
+      I_Error("W_AddZipFile: %s has a corrupt central directory", wadfile->name);
+
+    if (namelen == 0 || entry[ZIP_CENTRAL_SIZE + namelen - 1] == '/')
+    {
+      // folder entry
+    }
+    else if ((ZIP_WORD(entry + 8) & 1) || // encrypted
+        (method != ZIP_METHOD_STORED && method != ZIP_METHOD_DEFLATED) ||
+        !W_ZipLumpName((const char *)entry + ZIP_CENTRAL_SIZE, namelen, name, &li_namespace))
+    {
+      skipped++;
+    }
+    else
+    {
+      lump_p = &lumpinfo[numlumps++];
+      strncpy(lump_p->name, name, 8);
+      lump_p->name[8] = 0;
+      lump_p->size = ZIP_LONG(entry + 24);
+      lump_p->li_namespace = li_namespace;
+      lump_p->wadfile = wadfile;
+      lump_p->position = ZIP_LONG(entry + 42); // local header, see W_ReadZipLump
+      lump_p->source = wadfile->src;
+      lump_p->flags = flags | LUMP_ZIPENTRY |
+        (method == ZIP_METHOD_DEFLATED ? LUMP_DEFLATED : 0);
+      lump_p->compressed_size = ZIP_LONG(entry + 20);
+    }
+
+    entry += ZIP_CENTRAL_SIZE + namelen + ZIP_WORD(entry + 30) + ZIP_WORD(entry + 32);
+  }
+
+  free(dir);
+
+  if (skipped)
+    lprintf(LO_INFO, " %d entries of %s were skipped\n", skipped, wadfile->name);
+}
+
+//
+// W_ReadZipLump
+// Reads an archive lump, inflating it if needed.
+//
+
+void W_ReadZipLump(lumpinfo_t *l, void *dest)
+{
+  int handle = l->wadfile->handle;
+
+  // resolve the data offset from the local header once
+  if (l->flags & LUMP_ZIPENTRY)
+  {
+    byte local[ZIP_LOCAL_SIZE];
+
+    lseek(handle, l->position, SEEK_SET);
+    I_Read(handle, local, ZIP_LOCAL_SIZE);
+    if (ZIP_LONG(local) != ZIP_LOCAL_SIG)
+      I_Error("W_ReadZipLump: bad local header for %.8s in %s",
+              l->name, l->wadfile->name);
+
+    l->position += ZIP_LOCAL_SIZE + ZIP_WORD(local + 26) + ZIP_WORD(local + 28);
+    l->flags &= ~LUMP_ZIPENTRY;
+  }
+
+  lseek(handle, l->position, SEEK_SET);
+
+  if (!(l->flags & LUMP_DEFLATED))
+  {
+    I_Read(handle, dest, l->size);
+    return;
+  }
+
+#ifdef HAVE_LIBZ
+  {
+    z_stream zstream;
+    byte *input = malloc(l->compressed_size);
+    int err;
+
+    I_Read(handle, input, l->compressed_size);
+
+    memset(&zstream, 0, sizeof(zstream));
+    zstream.next_in = input;
+    zstream.avail_in = l->compressed_size;
+    zstream.next_out = dest;
+    zstream.avail_out = l->size;
+
+    // raw deflate stream, no zlib header
+    if (inflateInit2(&zstream, -MAX_WBITS) != Z_OK)
+      I_Error("W_ReadZipLump: Error during decompression initialization!");
+
+    err = inflate(&zstream, Z_FINISH);
+    if (err != Z_STREAM_END || zstream.total_out != (uLong)l->size)
+      I_Error("W_ReadZipLump: Error decompressing %.8s in %s",
+              l->name, l->wadfile->name);
+
+    inflateEnd(&zstream);
+    free(input);
+  }
+#else
+  I_Error("W_ReadZipLump: %.8s in %s is compressed, but zlib support is not compiled in",
+          l->name, l->wadfile->name);
+#endif
+}
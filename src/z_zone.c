@@ -117,6 +117,12 @@ static memblock_t *blockbytag[PU_MAX];
 static int memory_size = 0;
 static int free_memory = 0;
 
+// Limit on purgable (PU_CACHE) memory in kilobytes, 0 means unlimited.
+// Lumps, patches and composite textures all share this budget.
+int cache_memory_budget = 0;
+
+zone_cachestats_t zone_cachestats;
+
 #ifdef INSTRUMENTED
 
 // statistics for evaluating performance
@@ -326,6 +332,42 @@ void Z_Init(void)
 #endif
 }
 
+/* Z_FreeCacheLRU
+ * Frees purgable blocks, least recently released first, until at least
+ * 'needed' bytes have been reclaimed. Returns false if the cache is empty.
+ *
+ * Purgable blocks are appended to the tail of blockbytag[PU_CACHE] whenever
+ * they are allocated or unlocked (Z_ChangeTag), so the head of the list is
+ * always the block that has gone unused the longest.
+ */
+
+static dboolean Z_FreeCacheLRU(size_t needed
+#ifdef INSTRUMENTED
+                               , const char *file, int line
+#endif
+                               )
+{
+  size_t freed = 0;
+
+  if (!blockbytag[PU_CACHE])
+    return false;
+
+  while (blockbytag[PU_CACHE] && freed < needed)
+  {
+    memblock_t *block = blockbytag[PU_CACHE];
+
+    freed += block->size;
+    zone_cachestats.evictions++;
+    zone_cachestats.evicted_bytes += block->size;
+#ifdef INSTRUMENTED
+    (Z_Free)((char *) block + HEADER_SIZE, file, line);
+#else
+    (Z_Free)((char *) block + HEADER_SIZE);
+#endif
+  }
+  return true;
+}
+
 /* Z_Malloc
  * You can pass a NULL user if the tag is < PU_PURGELEVEL.
  *
@@ -393,12 +435,25 @@ void *(Z_Malloc)(size_t size, int tag, void **user
     block = NULL;
   }
 
+  // keep purgable memory within cache_memory_budget by dropping the least
+  // recently used blocks before a new one is cached
+  if (tag == PU_CACHE && cache_memory_budget > 0)
+  {
+    size_t budget = (size_t)cache_memory_budget * 1024;
+
+    if (zone_cachestats.cached_bytes + size > budget)
+      Z_FreeCacheLRU(zone_cachestats.cached_bytes + size -
+                     (budget > size ? budget : size) DA(file, line));
+  }
+
 #ifdef HAVE_LIBDMALLOC
   while (!(block = dmalloc_malloc(file,line,size + HEADER_SIZE,DMALLOC_FUNC_MALLOC,0,0))) {
 #else
   while (!(block = (malloc)(size + HEADER_SIZE))) {
 #endif
-    if (!blockbytag[PU_CACHE])
+    // cph - out of memory: give back purgable blocks, oldest first, rather
+    // than flushing the whole cache at once
+    if (!Z_FreeCacheLRU(size + HEADER_SIZE DA(file, line)))
       I_Error ("Z_Malloc: Failure trying to allocate %lu bytes"
 #ifdef INSTRUMENTED
                "\nSource: %s:%d"
@@ -408,7 +463,6 @@ void *(Z_Malloc)(size_t size, int tag, void **user
                , file, line
 #endif
       );
-    Z_FreeTags(PU_CACHE,PU_CACHE);
   }
 
   if (!blockbytag[tag])
@@ -433,6 +487,8 @@ void *(Z_Malloc)(size_t size, int tag, void **user
     active_memory += block->size;
 #endif
   free_memory -= block->size;
+  if (tag == PU_CACHE)
+    zone_cachestats.cached_bytes += block->size;
 
 #ifdef INSTRUMENTED
   block->file = file;
@@ -502,6 +558,8 @@ void (Z_Free)(void *p
   block->next->prev = block->prev;
 
   free_memory += block->size;
+  if (block->tag == PU_CACHE)
+    zone_cachestats.cached_bytes -= block->size;
 #ifdef INSTRUMENTED
   if (block->tag >= PU_PURGELEVEL)
     purgable_memory -= block->size;
@@ -624,6 +682,11 @@ void (Z_ChangeTag)(void *ptr, int tag
     blockbytag[tag]->prev = block;
   }
 
+  if (tag == PU_CACHE)
+    zone_cachestats.cached_bytes += block->size;
+  else if (block->tag == PU_CACHE)
+    zone_cachestats.cached_bytes -= block->size;
+
 #ifdef INSTRUMENTED
   if (block->tag < PU_PURGELEVEL && tag >= PU_PURGELEVEL)
   {
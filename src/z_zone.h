@@ -82,6 +82,20 @@ char *(Z_Strdup)(const char *s, int tag, void **user DA(const char *, int));
 void (Z_CheckHeap)(DAC(const char *,int));   // killough 3/22/98: add file/line info
 void Z_DumpHistory(char *);
 
+/* Purgable cache accounting. Hits and misses are counted by the lump, patch
+ * and composite texture caches; evictions by the zone allocator itself. */
+typedef struct
+{
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int evictions;
+  size_t cached_bytes;
+  size_t evicted_bytes;
+} zone_cachestats_t;
+
+extern zone_cachestats_t zone_cachestats;
+extern int cache_memory_budget;     // kilobytes, 0 = unlimited
+
 #ifdef INSTRUMENTED
 /* cph - save space if not debugging, don't require file 
  * and line to memory calls */
@@ -0,0 +1,223 @@
+/*
+ * Host test and benchmark for the atlas shelf packer in
+ * src/gl_shelfpack.c.
+ *
+ * Checks:
+ *  - the placements of a fixed sequence worked out by hand,
+ *  - random items stay on the page and never overlap,
+ *  - a full page refuses items without changing its shelves, and packs
+ *    again from the top left corner after a reset.
+ *
+ *   test_atlas          run the correctness test
+ *   test_atlas -bench   also time packing and report page fill
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gl_shelfpack.h"
+
+#define PAGE_SIZE 256
+
+// gl_shelfpack.c allocates through the zone
+void *(Z_Realloc)(void *p, size_t n, int tag, void **user)
+{
+  return realloc(p, n);
+}
+
+void (Z_Free)(void *p)
+{
+  free(p);
+}
+
+static unsigned int rnd_state = 1;
+
+static unsigned int rnd(void)
+{
+  rnd_state = rnd_state * 1103515245 + 12345;
+  return rnd_state >> 8;
+}
+
+// HUD sized items: mostly small glyphs, some larger status bar pieces
+static void random_item(int *width, int *height)
+{
+  if (rnd() % 8)
+  {
+    *width = 3 + rnd() % 12;
+    *height = 6 + rnd() % 8;
+  }
+  else
+  {
+    *width = 8 + rnd() % 121;
+    *height = 8 + rnd() % 121;
+  }
+}
+
+static int test_placements(void)
+{
+  static const struct { int width, height, x, y, ok; } items[] = {
+    { 4, 4,  0, 0, 1},
+    { 4, 4,  4, 0, 1},
+    { 4, 2,  8, 0, 1},  // not short enough to open a new shelf
+    { 4, 1,  0, 4, 1},  // too short for the first shelf
+    {16, 8,  0, 5, 1},
+    { 4, 4, 12, 0, 1},  // fills the first shelf
+    { 4, 4,  0, 0, 0},  // no shelf room and no room for a new shelf
+    { 2, 1,  4, 4, 1},
+    {17, 1,  0, 0, 0},  // wider than the page
+  };
+  shelfpack_t pack = {0};
+  int i, failures = 0;
+
+  for (i = 0; i < (int)(sizeof(items) / sizeof(items[0])); i++)
+  {
+    int x = -1, y = -1;
+    int ok = gld_ShelfPack(&pack, 16, items[i].width, items[i].height, &x, &y);
+
+    if (ok != items[i].ok || (ok && (x != items[i].x || y != items[i].y)))
+    {
+      printf("FAIL item %d (%dx%d): got %d at %d,%d, expected %d at %d,%d\n",
+             i, items[i].width, items[i].height, ok, x, y,
+             items[i].ok, items[i].x, items[i].y);
+      failures++;
+    }
+  }
+
+  free(pack.shelves);
+  return failures;
+}
+
+// Fills pages with random items until the page refuses several in a row,
+// checking every placement against an occupancy map.
+static int test_random_pages(int pages)
+{
+  static unsigned char used[PAGE_SIZE][PAGE_SIZE];
+  shelfpack_t pack = {0};
+  shelfpack_shelf_t *saved = malloc(PAGE_SIZE * sizeof(*saved));
+  int page, failures = 0;
+
+  for (page = 0; page < pages && !failures; page++)
+  {
+    int misses = 0;
+
+    memset(used, 0, sizeof(used));
+    gld_ShelfPackReset(&pack);
+
+    while (misses < 32 && !failures)
+    {
+      int width, height, x, y, i, j;
+      int numshelves = pack.numshelves, bottom = pack.bottom;
+
+      random_item(&width, &height);
+      memcpy(saved, pack.shelves, numshelves * sizeof(*saved));
+
+      if (!gld_ShelfPack(&pack, PAGE_SIZE, width, height, &x, &y))
+      {
+        if (pack.numshelves != numshelves || pack.bottom != bottom ||
+            memcmp(saved, pack.shelves, numshelves * sizeof(*saved)))
+        {
+          printf("FAIL page %d: a refused %dx%d item changed the page\n",
+                 page, width, height);
+          failures++;
+        }
+        misses++;
+        continue;
+      }
+
+      if (x < 0 || y < 0 || x + width > PAGE_SIZE || y + height > PAGE_SIZE)
+      {
+        printf("FAIL page %d: %dx%d item at %d,%d is off the page\n",
+               page, width, height, x, y);
+        failures++;
+        break;
+      }
+
+      for (j = y; j < y + height; j++)
+        for (i = x; i < x + width; i++)
+          if (used[j][i]++)
+          {
+            printf("FAIL page %d: %dx%d item at %d,%d overlaps at %d,%d\n",
+                   page, width, height, x, y, i, j);
+            failures++;
+            j = y + height;
+            break;
+          }
+    }
+
+    // a reset page starts over in the corner
+    if (!failures)
+    {
+      int x, y;
+
+      gld_ShelfPackReset(&pack);
+      if (!gld_ShelfPack(&pack, PAGE_SIZE, 8, 8, &x, &y) || x || y)
+      {
+        printf("FAIL page %d: first item after a reset is not at 0,0\n", page);
+        failures++;
+      }
+    }
+  }
+
+  free(saved);
+  free(pack.shelves);
+  return failures;
+}
+
+static double now_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Packs random items, resetting the page whenever it refuses one, and
+// reports the time per item and how much of a page was used when it
+// first filled up.
+static void bench_packer(void)
+{
+  const int items = 2000000;
+  shelfpack_t pack = {0};
+  double t, fill = 0;
+  int i, area = 0, pages = 0;
+
+  t = now_ms();
+  for (i = 0; i < items; i++)
+  {
+    int width, height, x, y;
+
+    random_item(&width, &height);
+    if (!gld_ShelfPack(&pack, PAGE_SIZE, width, height, &x, &y))
+    {
+      fill += (double)area / (PAGE_SIZE * PAGE_SIZE);
+      pages++;
+      area = 0;
+      gld_ShelfPackReset(&pack);
+      gld_ShelfPack(&pack, PAGE_SIZE, width, height, &x, &y);
+    }
+    area += width * height;
+  }
+  t = now_ms() - t;
+
+  printf("shelf packer: %.1f ns/item, %.1f%% of a %dx%d page used when full (%d pages)\n",
+         t * 1000000.0 / items, pages ? fill * 100.0 / pages : 0.0,
+         PAGE_SIZE, PAGE_SIZE, pages);
+
+  free(pack.shelves);
+}
+
+int main(int argc, char **argv)
+{
+  int failures = test_placements();
+
+  failures += test_random_pages(500);
+
+  printf("atlas packer: %s\n", failures ? "FAILED" : "ok");
+
+  if (argc > 1 && !strcmp(argv[1], "-bench"))
+    bench_packer();
+
+  return failures != 0;
+}
@@ -0,0 +1,354 @@
+/*
+ * Host test and benchmark for the buffered demo writer in
+ * src/g_demobuf.c.
+ *
+ * Demos are recorded twice. The first writer is the unbuffered one that
+ * g_game.c used before: every ticcmd is written as it comes, then a
+ * DEMOMARKER and the footer. The second is the buffered writer. The
+ * footer here grows with the tic count once a nonzero pitch is seen, the
+ * way the demoex mouselook lump does. Checks:
+ *  - after every tic, the file on disk plays back as a complete demo.
+ *    It is byte-identical to the unbuffered writer's demo stopped at the
+ *    same tic, at most DEMO_FLUSH_TICS behind.
+ *  - a normal stop gives the unbuffered writer's file.
+ *  - an abnormal exit, which runs only the exit handler's checkpoint,
+ *    gives the unbuffered writer's file stopped at the last tic.
+ *  - the copy returned for reading back is the ticcmd that was written.
+ *
+ *   test_demobuf          run the correctness test
+ *   test_demobuf -bench   also time recording
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "g_demobuf.h"
+
+#define DEMO_NAME "test_demobuf.lmp"
+#define REF_NAME "test_demobuf_ref.lmp"
+#define DEMOMARKER 0x80 // as in g_game.h
+
+// doomdef.h sends malloc and free to the zone, this test has none
+#undef malloc
+#undef realloc
+#undef free
+
+void I_Error(const char *error, ...)
+{
+  va_list args;
+
+  va_start(args, error);
+  vprintf(error, args);
+  va_end(args);
+  printf("\n");
+  exit(1);
+}
+
+static const byte header[13] = {
+  202, 4, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0
+};
+
+typedef struct
+{
+  int players;
+  int ticsize;        // 4, or 5 with longtics
+  int pitch_from;     // first tic with a nonzero pitch, -1 for none
+  int tics;           // where the recording stops
+  int back_at;        // tic where a loaded game moves gametic back, or -1
+} demo_t;
+
+static unsigned int rnd_state = 1;
+
+static unsigned int rnd(void)
+{
+  rnd_state = rnd_state * 1103515245 + 12345;
+  return rnd_state >> 8;
+}
+
+// the ticcmd of a player, never starting with a DEMOMARKER
+static void make_cmd(const demo_t *demo, int tic, int player, byte *cmd)
+{
+  unsigned int h = (tic * 4 + player + 1) * 2654435761u;
+  int i;
+
+  for (i = 0; i < demo->ticsize; i++, h = h * 2654435761u + 7)
+    cmd[i] = h >> 24;
+  cmd[0] = (byte)((int)(h % 101) - 50);
+}
+
+// number of tics the footer below has mouselook data for
+static const demo_t *end_demo;
+static int end_tics;
+
+// DEMOMARKER, then a footer standing in for the demoex lumps
+static void write_end(FILE *file)
+{
+  static const char port[] = "PrBoom-Plus test";
+  static short *pitch;
+  static int maxpitch;
+  int i;
+
+  fputc(DEMOMARKER, file);
+  fwrite("PWAD", 4, 1, file);
+  if (end_demo->pitch_from >= 0 && end_tics > end_demo->pitch_from)
+  {
+    if (end_tics > maxpitch)
+    {
+      maxpitch = end_tics * 2;
+      pitch = realloc(pitch, maxpitch * sizeof(*pitch));
+    }
+    for (i = 0; i < end_tics; i++)
+      pitch[i] = i >= end_demo->pitch_from ? (short)(i * 37 + 1) : 0;
+
+    fwrite("MLOOK", 5, 1, file);
+    fwrite(pitch, sizeof(*pitch), end_tics, file);
+  }
+  fwrite(port, sizeof(port), 1, file);
+}
+
+static byte *read_file(const char *name, long *size)
+{
+  FILE *f = fopen(name, "rb");
+  byte *data;
+
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  data = malloc(*size + 1);
+  if (*size && fread(data, *size, 1, f) != 1)
+    *size = -1;
+  fclose(f);
+  return data;
+}
+
+// What the unbuffered writer leaves after tics tics and a normal stop
+static byte *reference(const demo_t *demo, int tics, long *size)
+{
+  FILE *f = fopen(REF_NAME, "wb");
+  byte cmd[5];
+  int tic, player, saved_tics = end_tics;
+
+  fwrite(header, sizeof(header), 1, f);
+  for (tic = 0; tic < tics; tic++)
+    for (player = 0; player < demo->players; player++)
+    {
+      make_cmd(demo, tic, player, cmd);
+      fwrite(cmd, demo->ticsize, 1, f);
+    }
+
+  end_demo = demo;
+  end_tics = tics;
+  write_end(f);
+  end_tics = saved_tics;
+  fclose(f);
+
+  return read_file(REF_NAME, size);
+}
+
+// Plays back the demo on disk and returns the number of tics in it, or
+// -1 if it is not the unbuffered writer's demo of that many tics.
+static int check_on_disk(const demo_t *demo)
+{
+  long size, refsize, pos = sizeof(header);
+  byte *data = read_file(DEMO_NAME, &size);
+  byte *ref, cmd[5];
+  int tics = 0, player, result = -1;
+
+  if (size < (long)sizeof(header) || memcmp(data, header, sizeof(header)))
+  {
+    free(data);
+    return -1;
+  }
+
+  while (pos < size && data[pos] != DEMOMARKER)
+  {
+    for (player = 0; player < demo->players; player++, pos += demo->ticsize)
+    {
+      make_cmd(demo, tics, player, cmd);
+      if (pos + demo->ticsize > size || memcmp(data + pos, cmd, demo->ticsize))
+      {
+        free(data);
+        return -1;
+      }
+    }
+    tics++;
+  }
+
+  ref = reference(demo, tics, &refsize);
+  if (size == refsize && !memcmp(data, ref, size))
+    result = tics;
+
+  free(ref);
+  free(data);
+  return result;
+}
+
+// Records demo with the buffered writer. The recording ends with a
+// normal stop, or like an I_Error with only the exit handler run.
+static int test_demo(const demo_t *demo, int abnormal)
+{
+  FILE *f = fopen(DEMO_NAME, "wb");
+  byte cmd[5];
+  long size, refsize;
+  byte *data, *ref;
+  int tic, player, gametic = 100, failures = 0;
+
+  end_demo = demo;
+  end_tics = 0;
+
+  fwrite(header, sizeof(header), 1, f);
+  G_DemoBufferStart(f, write_end, gametic);
+
+  for (tic = 0; tic < demo->tics && !failures; tic++, gametic++)
+  {
+    int ondisk;
+
+    if (tic == demo->back_at)
+      gametic -= 1000;
+
+    for (player = 0; player < demo->players; player++)
+    {
+      const byte *copy;
+
+      make_cmd(demo, tic, player, cmd);
+      copy = G_DemoBufferWrite(cmd, demo->ticsize, gametic);
+      if (memcmp(copy, cmd, demo->ticsize))
+      {
+        printf("FAIL tic %d player %d: read back a different ticcmd\n", tic, player);
+        failures++;
+      }
+    }
+    // the mouselook lump grows after the tic, in P_Ticker
+    end_tics = tic + 1;
+
+    ondisk = check_on_disk(demo);
+    if (ondisk < 0 || tic + 1 - ondisk > DEMO_FLUSH_TICS)
+    {
+      printf("FAIL %d players, pitch from %d: after tic %d the file %s\n",
+             demo->players, demo->pitch_from, tic,
+             ondisk < 0 ? "is not a complete demo" : "is too far behind");
+      failures++;
+    }
+  }
+
+  if (abnormal)
+    G_DemoBufferFlush(true);
+  else
+    G_DemoBufferStop();
+  fclose(f);
+
+  data = read_file(DEMO_NAME, &size);
+  ref = reference(demo, demo->tics, &refsize);
+  if (size != refsize || memcmp(data, ref, size))
+  {
+    printf("FAIL %d players, %d tics, pitch from %d: %s stop differs from the unbuffered writer\n",
+           demo->players, demo->tics, demo->pitch_from, abnormal ? "abnormal" : "normal");
+    failures++;
+  }
+
+  free(data);
+  free(ref);
+  return failures;
+}
+
+static int test_demos(void)
+{
+  static const demo_t fixed[] = {
+    {1, 4, -1,    0, -1},   // stopped before the first tic
+    {1, 4, -1,    1, -1},
+    {1, 5,  0, 1000, -1},
+    {4, 4, 300, 800, -1},
+    {2, 5, 10,  700, 400},  // gametic moves back on a loaded game
+  };
+  int i, failures = 0;
+
+  for (i = 0; i < (int)(sizeof(fixed) / sizeof(fixed[0])); i++)
+  {
+    failures += test_demo(&fixed[i], false);
+    failures += test_demo(&fixed[i], true);
+  }
+
+  for (i = 0; i < 10 && !failures; i++)
+  {
+    demo_t demo;
+
+    demo.players = 1 + rnd() % 4;
+    demo.ticsize = 4 + rnd() % 2;
+    demo.tics = rnd() % 1200;
+    demo.pitch_from = (int)(rnd() % (demo.tics + 2)) - 1;
+    demo.back_at = rnd() & 1 ? (int)(rnd() % (demo.tics + 1)) : -1;
+    failures += test_demo(&demo, rnd() & 1);
+  }
+
+  return failures;
+}
+
+static double now_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// An hour of four player demo, written tic by tic and buffered
+static void bench_writer(void)
+{
+  const demo_t demo = {4, 5, 0, 35 * 3600, -1};
+  byte cmd[5];
+  double t, buffered;
+  FILE *f;
+  int tic, player;
+
+  end_demo = &demo;
+
+  t = now_ms();
+  f = fopen(DEMO_NAME, "wb");
+  for (tic = 0; tic < demo.tics; tic++)
+    for (player = 0; player < demo.players; player++)
+    {
+      make_cmd(&demo, tic, player, cmd);
+      fwrite(cmd, demo.ticsize, 1, f);
+    }
+  end_tics = demo.tics;
+  write_end(f);
+  fclose(f);
+  t = now_ms() - t;
+
+  buffered = now_ms();
+  f = fopen(DEMO_NAME, "wb");
+  G_DemoBufferStart(f, write_end, 0);
+  for (tic = 0; tic < demo.tics; tic++)
+  {
+    end_tics = tic;
+    for (player = 0; player < demo.players; player++)
+    {
+      make_cmd(&demo, tic, player, cmd);
+      G_DemoBufferWrite(cmd, demo.ticsize, tic);
+    }
+  }
+  end_tics = demo.tics;
+  G_DemoBufferStop();
+  fclose(f);
+  buffered = now_ms() - buffered;
+
+  printf("demo writer: %d tics, unbuffered %.1f ms, buffered with checkpoints %.1f ms (%d checkpoints)\n",
+         demo.tics, t, buffered, demo.tics / DEMO_FLUSH_TICS);
+}
+
+int main(int argc, char **argv)
+{
+  int failures = test_demos();
+
+  printf("demo writer: %s\n", failures ? "FAILED" : "ok");
+
+  if (argc > 1 && !strcmp(argv[1], "-bench"))
+    bench_writer();
+
+  remove(DEMO_NAME);
+  remove(REF_NAME);
+  return failures != 0;
+}
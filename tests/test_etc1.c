@@ -0,0 +1,352 @@
+/*
+ * Host test and benchmark for the ETC1 / ETC1A4 encoder in
+ * src/gl_etc1enc.c.
+ *
+ * The output is decoded with the reference decoder below, written from
+ * the ETC1 specification, and checked for:
+ *  - the output size and deterministic output,
+ *  - exact 4 bit alpha in ETC1A4 blocks,
+ *  - transparent texels not affecting the colors of opaque ones,
+ *  - a minimum PSNR on smooth, noisy and flat test images.
+ *
+ *   test_etc1          run the correctness test
+ *   test_etc1 -bench   also report PSNR and encoder throughput
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gl_etc1enc.h"
+
+static const int modifiers[8][4] = {
+  {2, 8, -2, -8}, {5, 17, -5, -17}, {9, 29, -9, -29}, {13, 42, -13, -42},
+  {18, 60, -18, -60}, {24, 80, -24, -80}, {33, 106, -33, -106}, {47, 183, -47, -183}
+};
+
+static unsigned int rnd_state = 1;
+
+static unsigned int rnd(void)
+{
+  rnd_state = rnd_state * 1103515245 + 12345;
+  return rnd_state >> 8;
+}
+
+static int clamp255(int v)
+{
+  return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static int sext3(int v)
+{
+  return v & 4 ? v - 8 : v;
+}
+
+// Decodes one 8 byte ETC1 block into rgba (4x4 texels, row major)
+static void decode_block(const unsigned char *in, unsigned char *rgba)
+{
+  unsigned int hi = (in[0] << 24) | (in[1] << 16) | (in[2] << 8) | in[3];
+  unsigned int lo = (in[4] << 24) | (in[5] << 16) | (in[6] << 8) | in[7];
+  int base[2][3], table[2], flip = hi & 1;
+  int c, x, y;
+
+  for (c = 0; c < 3; c++)
+  {
+    int shift = 24 - c * 8;
+
+    if (hi & 2)
+    {
+      int b1 = (hi >> (shift + 3)) & 31;
+      int b2 = b1 + sext3((hi >> shift) & 7);
+
+      base[0][c] = (b1 << 3) | (b1 >> 2);
+      base[1][c] = (b2 << 3) | (b2 >> 2);
+    }
+    else
+    {
+      base[0][c] = ((hi >> (shift + 4)) & 15) * 17;
+      base[1][c] = ((hi >> shift) & 15) * 17;
+    }
+  }
+  table[0] = (hi >> 5) & 7;
+  table[1] = (hi >> 2) & 7;
+
+  for (x = 0; x < 4; x++)
+    for (y = 0; y < 4; y++)
+    {
+      int i = x * 4 + y;
+      int h = (flip ? y : x) >= 2;
+      int index = (((lo >> (i + 16)) & 1) << 1) | ((lo >> i) & 1);
+      int d = modifiers[table[h]][index];
+      unsigned char *t = rgba + (y * 4 + x) * 4;
+
+      for (c = 0; c < 3; c++)
+        t[c] = clamp255(base[h][c] + d);
+      t[3] = 255;
+    }
+}
+
+static void decode(const unsigned char *in, int width, int height,
+                   int use_alpha, unsigned char *rgba)
+{
+  unsigned char block[16 * 4];
+  int bx, by, x, y;
+
+  for (by = 0; by < height; by += 4)
+    for (bx = 0; bx < width; bx += 4)
+    {
+      unsigned long long alpha = 0;
+
+      if (use_alpha)
+      {
+        for (x = 0; x < 8; x++)
+          alpha |= (unsigned long long)in[x] << (x * 8);
+        in += 8;
+      }
+
+      decode_block(in, block);
+      in += 8;
+
+      for (x = 0; x < 4; x++)
+        for (y = 0; y < 4; y++)
+        {
+          unsigned char *t = rgba + ((by + y) * width + bx + x) * 4;
+
+          memcpy(t, block + (y * 4 + x) * 4, 4);
+          if (use_alpha)
+            t[3] = ((alpha >> ((x * 4 + y) * 4)) & 15) * 17;
+        }
+    }
+}
+
+// PSNR over the color of the texels that are not transparent
+static double psnr(const unsigned char *a, const unsigned char *b, int texels)
+{
+  double se = 0;
+  int i, c, n = 0;
+
+  for (i = 0; i < texels; i++, a += 4, b += 4)
+  {
+    if (!a[3])
+      continue;
+    for (c = 0; c < 3; c++)
+      se += (a[c] - b[c]) * (a[c] - b[c]);
+    n += 3;
+  }
+
+  if (!se)
+    return 99.0;
+  return 10.0 * log10(255.0 * 255.0 * n / se);
+}
+
+enum { IMG_GRADIENT, IMG_NOISY, IMG_FLAT, IMG_SPRITE, NUM_IMAGES };
+
+static const char *image_names[NUM_IMAGES] = {
+  "gradient", "noisy gradient", "flat blocks", "sprite"
+};
+
+// minimum PSNR each image must reach
+static const double image_psnr[NUM_IMAGES] = {38.0, 34.0, 38.0, 34.0};
+
+static void make_image(int type, unsigned char *rgba, int width, int height)
+{
+  int x, y;
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+    {
+      unsigned char *t = rgba + (y * width + x) * 4;
+      int n = type == IMG_NOISY || type == IMG_SPRITE ? (int)(rnd() % 33) - 16 : 0;
+
+      if (type == IMG_FLAT)
+      {
+        // one random color per 4x4 block
+        unsigned int seed = ((y / 4) * 977 + (x / 4)) * 2654435761u;
+
+        t[0] = seed >> 24;
+        t[1] = seed >> 16;
+        t[2] = seed >> 8;
+      }
+      else
+      {
+        t[0] = clamp255(x * 255 / width + n);
+        t[1] = clamp255(y * 255 / height + n);
+        t[2] = clamp255((x + y) * 255 / (width + height) + n);
+      }
+      t[3] = 255;
+
+      // sprites: a transparent frame with garbage color
+      if (type == IMG_SPRITE && ((x * 7 + y * 3) % 11 < 3))
+      {
+        t[0] = rnd();
+        t[1] = rnd();
+        t[2] = rnd();
+        t[3] = 0;
+      }
+    }
+}
+
+static int test_image(int type, int width, int height, int use_alpha, double *result)
+{
+  int texels = width * height;
+  int expected = texels / (use_alpha ? 1 : 2);
+  unsigned char *rgba = malloc(texels * 4);
+  unsigned char *out = malloc(texels);
+  unsigned char *out2 = malloc(texels);
+  unsigned char *dec = malloc(texels * 4);
+  int size, i, failures = 0;
+
+  make_image(type, rgba, width, height);
+
+  size = gld_EncodeETC1(rgba, width, height, use_alpha, out);
+  if (size != expected)
+  {
+    printf("FAIL %s %dx%d: %d bytes, expected %d\n",
+           image_names[type], width, height, size, expected);
+    failures++;
+  }
+
+  gld_EncodeETC1(rgba, width, height, use_alpha, out2);
+  if (memcmp(out, out2, expected))
+  {
+    printf("FAIL %s %dx%d: output is not deterministic\n",
+           image_names[type], width, height);
+    failures++;
+  }
+
+  decode(out, width, height, use_alpha, dec);
+
+  if (use_alpha)
+    for (i = 0; i < texels; i++)
+      if (dec[i * 4 + 3] != (rgba[i * 4 + 3] >> 4) * 17)
+      {
+        printf("FAIL %s %dx%d: alpha of texel %d is %d, expected %d\n",
+               image_names[type], width, height, i,
+               dec[i * 4 + 3], (rgba[i * 4 + 3] >> 4) * 17);
+        failures++;
+        break;
+      }
+
+  // a few texels can't hold a whole gradient, skip the quality check there
+  *result = psnr(rgba, dec, texels);
+  if (width >= 32 && height >= 32 && *result < image_psnr[type])
+  {
+    printf("FAIL %s %dx%d: PSNR %.2f dB, expected at least %.2f\n",
+           image_names[type], width, height, *result, image_psnr[type]);
+    failures++;
+  }
+
+  free(rgba);
+  free(out);
+  free(out2);
+  free(dec);
+  return failures;
+}
+
+// The same opaque texels must encode the same way whatever color the
+// transparent texels in the block have.
+static int test_transparent_ignored(void)
+{
+  unsigned char a[16 * 4], b[16 * 4], out_a[16], out_b[16];
+  int i, iter, failures = 0;
+
+  for (iter = 0; iter < 1000; iter++)
+  {
+    for (i = 0; i < 16; i++)
+    {
+      int opaque = rnd() & 1;
+
+      a[i * 4 + 0] = b[i * 4 + 0] = rnd();
+      a[i * 4 + 1] = b[i * 4 + 1] = rnd();
+      a[i * 4 + 2] = b[i * 4 + 2] = rnd();
+      a[i * 4 + 3] = b[i * 4 + 3] = opaque ? 255 : 0;
+      if (!opaque)
+      {
+        b[i * 4 + 0] = rnd();
+        b[i * 4 + 1] = rnd();
+        b[i * 4 + 2] = rnd();
+      }
+    }
+
+    gld_EncodeETC1(a, 4, 4, true, out_a);
+    gld_EncodeETC1(b, 4, 4, true, out_b);
+    if (memcmp(out_a, out_b, 16))
+    {
+      printf("FAIL transparent texel colors changed the encoding\n");
+      failures++;
+      break;
+    }
+  }
+
+  return failures;
+}
+
+static double now_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int bench_encoder(void)
+{
+  const int width = 256, height = 256, runs = 10;
+  unsigned char *rgba = malloc(width * height * 4);
+  unsigned char *out = malloc(width * height);
+  int type, use_alpha, i, failures = 0;
+
+  for (type = 0; type < NUM_IMAGES; type++)
+  {
+    make_image(type, rgba, width, height);
+
+    // sprites need the alpha to hide their transparent texels
+    for (use_alpha = type == IMG_SPRITE; use_alpha < 2; use_alpha++)
+    {
+      double t = now_ms(), ps;
+
+      for (i = 0; i < runs; i++)
+        gld_EncodeETC1(rgba, width, height, use_alpha, out);
+      t = (now_ms() - t) / runs;
+
+      failures += test_image(type, width, height, use_alpha, &ps);
+      printf("%-15s %s: %6.2f dB, %6.2f ms, %6.2f Mtexel/s\n",
+             image_names[type], use_alpha ? "ETC1A4" : "ETC1  ",
+             ps, t, width * height / (t * 1000.0));
+    }
+  }
+
+  free(rgba);
+  free(out);
+  return failures;
+}
+
+int main(int argc, char **argv)
+{
+  static const int sizes[][2] = {{4, 4}, {8, 4}, {64, 64}, {128, 32}, {256, 256}};
+  int failures = 0;
+  unsigned int s;
+  int type;
+
+  for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    for (type = 0; type < NUM_IMAGES; type++)
+    {
+      double ps;
+
+      // only sprites have transparent texels
+      failures += test_image(type, sizes[s][0], sizes[s][1], type == IMG_SPRITE, &ps);
+      if (type != IMG_SPRITE)
+        failures += test_image(type, sizes[s][0], sizes[s][1], true, &ps);
+    }
+
+  failures += test_transparent_ignored();
+
+  printf("etc1 encoder: %s\n", failures ? "FAILED" : "ok");
+
+  if (argc > 1 && !strcmp(argv[1], "-bench"))
+    failures += bench_encoder();
+
+  return failures != 0;
+}
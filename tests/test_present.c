@@ -0,0 +1,192 @@
+/*
+ * Host test and benchmark for the rotating present kernels in
+ * src/v_present.c.
+ *
+ * Every kernel is checked against a plain per-pixel rotation over random
+ * rectangles, including odd sizes, odd destination heights and
+ * destinations that are not 32 bit aligned. Pixels outside the rectangle
+ * must be left alone.
+ *
+ *   test_present          run the correctness test
+ *   test_present -bench   also time full screen presents
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "v_present.h"
+
+#define SRC_W 400
+#define SRC_H 240
+#define SRC_PITCH (SRC_W + 16)
+#define SENTINEL 0xa5
+
+static unsigned int rnd_state = 1;
+
+static unsigned int rnd(void)
+{
+  rnd_state = rnd_state * 1103515245 + 12345;
+  return rnd_state >> 8;
+}
+
+static unsigned short ref15(unsigned short x)
+{
+  return (unsigned short)((x << 1) | (x >> 15));
+}
+
+static unsigned short ref16(unsigned short x)
+{
+  return x;
+}
+
+static unsigned int ref32(unsigned int x)
+{
+  return (x << 8) | (x >> 24);
+}
+
+typedef struct
+{
+  const char *name;
+  int bytes;
+} kernel_t;
+
+static const kernel_t kernels[] = {
+  {"V_RotateRect15", 2},
+  {"V_RotateRect16", 2},
+  {"V_RotateRect32", 4},
+};
+
+static void run_kernel(int k, const void *src, void *dst, int dst_height,
+                       int x1, int y1, int x2, int y2)
+{
+  switch (k)
+  {
+    case 0:
+      V_RotateRect15(src, SRC_PITCH, dst, dst_height, x1, y1, x2, y2);
+      break;
+    case 1:
+      V_RotateRect16(src, SRC_PITCH, dst, dst_height, x1, y1, x2, y2);
+      break;
+    default:
+      V_RotateRect32(src, SRC_PITCH, dst, dst_height, x1, y1, x2, y2);
+      break;
+  }
+}
+
+static void run_reference(int k, const void *src, void *dst, int dst_height,
+                          int x1, int y1, int x2, int y2)
+{
+  int x, y;
+
+  for (x = x1; x < x2; x++)
+    for (y = y1; y < y2; y++)
+    {
+      int s = y * SRC_PITCH + x;
+      int d = x * dst_height + dst_height - 1 - y;
+
+      if (k == 0)
+        ((unsigned short *)dst)[d] = ref15(((const unsigned short *)src)[s]);
+      else if (k == 1)
+        ((unsigned short *)dst)[d] = ref16(((const unsigned short *)src)[s]);
+      else
+        ((unsigned int *)dst)[d] = ref32(((const unsigned int *)src)[s]);
+    }
+}
+
+static int test_kernels(int iterations)
+{
+  size_t srcsize = SRC_PITCH * SRC_H * 4;
+  size_t dstsize = (SRC_W * (SRC_H + 1) + 2) * 4;
+  unsigned char *src = malloc(srcsize);
+  unsigned char *dst = malloc(dstsize + 4);
+  unsigned char *ref = malloc(dstsize + 4);
+  int i, k, failures = 0;
+  size_t n;
+
+  for (n = 0; n < srcsize; n++)
+    src[n] = rnd();
+
+  for (i = 0; i < iterations; i++)
+  {
+    for (k = 0; k < 3; k++)
+    {
+      int bytes = kernels[k].bytes;
+      // odd heights and an offset of one pixel break 32 bit alignment
+      int dst_height = SRC_H + (rnd() & 1);
+      int offset = (rnd() & 1) * bytes;
+      int x1 = rnd() % SRC_W, x2 = x1 + 1 + rnd() % (SRC_W - x1);
+      int y1 = rnd() % SRC_H, y2 = y1 + 1 + rnd() % (SRC_H - y1);
+
+      if (!(rnd() & 7))
+        x1 = y1 = 0, x2 = SRC_W, y2 = SRC_H;
+
+      memset(dst, SENTINEL, dstsize + 4);
+      memset(ref, SENTINEL, dstsize + 4);
+      run_kernel(k, src, dst + offset, dst_height, x1, y1, x2, y2);
+      run_reference(k, src, ref + offset, dst_height, x1, y1, x2, y2);
+
+      if (memcmp(dst, ref, dstsize + 4))
+      {
+        printf("FAIL %s rect %d,%d-%d,%d height %d offset %d\n",
+               kernels[k].name, x1, y1, x2, y2, dst_height, offset);
+        failures++;
+      }
+    }
+  }
+
+  free(src);
+  free(dst);
+  free(ref);
+  return failures;
+}
+
+static double now_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void bench_kernels(void)
+{
+  unsigned char *src = calloc(SRC_PITCH * SRC_H, 4);
+  unsigned char *dst = calloc(SRC_W * SRC_H, 4);
+  const int frames = 2000;
+  int i, k;
+
+  for (k = 0; k < 3; k++)
+  {
+    double t, ref_t;
+
+    t = now_ms();
+    for (i = 0; i < frames; i++)
+      run_kernel(k, src, dst, SRC_H, 0, 0, SRC_W, SRC_H);
+    t = now_ms() - t;
+
+    ref_t = now_ms();
+    for (i = 0; i < frames; i++)
+      run_reference(k, src, dst, SRC_H, 0, 0, SRC_W, SRC_H);
+    ref_t = now_ms() - ref_t;
+
+    printf("%s: %.3f ms/frame, scalar reference %.3f ms/frame (%dx%d)\n",
+           kernels[k].name, t / frames, ref_t / frames, SRC_W, SRC_H);
+  }
+
+  free(src);
+  free(dst);
+}
+
+int main(int argc, char **argv)
+{
+  int failures = test_kernels(2000);
+
+  printf("present kernels: %s\n", failures ? "FAILED" : "ok");
+
+  if (argc > 1 && !strcmp(argv[1], "-bench"))
+    bench_kernels();
+
+  return failures != 0;
+}